@@ -11,126 +11,202 @@ bool PairSecondGreater(const pair<T1, T2> &p1, const pair<T1, T2> &p2) {
     return p1.second > p2.second;
 }
 
-void AndOrDag::addWorkloadQuery(const std::string &q, size_t curFreq) {
-    int ret = addQuery(q);
-    if (ret >= 0) {
-        freq[ret] += curFreq;
-        workloadFreq[ret] += curFreq;
+// priority_queue whose elements can be visited in priority order without popping
+template<typename T, typename Compare>
+class InspectablePriorityQueue : public priority_queue<T, vector<T>, Compare> {
+public:
+    using priority_queue<T, vector<T>, Compare>::priority_queue;
+    // Visit the elements from the top down until visit returns false, by best-first search on the heap
+    template<typename Visit>
+    void visitInOrder(Visit visit) const {
+        const auto &c = this->c;
+        auto posLess = [&](size_t p1, size_t p2) { return this->comp(c[p1], c[p2]); };
+        vector<size_t> frontier;
+        if (!c.empty())
+            frontier.emplace_back(0);
+        while (!frontier.empty()) {
+            pop_heap(frontier.begin(), frontier.end(), posLess);
+            size_t pos = frontier.back();
+            frontier.pop_back();
+            if (!visit(c[pos]))
+                return;
+            for (size_t childPos = 2 * pos + 1; childPos <= 2 * pos + 2 && childPos < c.size(); childPos++) {
+                frontier.emplace_back(childPos);
+                push_heap(frontier.begin(), frontier.end(), posLess);
+            }
+        }
     }
+};
+
+/**
+ * @brief Add q to the dag and mark it as a workload query. On a dag past initAuxiliary, the new nodes get
+ * their auxiliary entries and topological orders; on a planned dag, they are also planned (on top of the
+ * existing plan and materialized views) and q's freq & useCnt are propagated, so q is ready to execute.
+ *
+ * @return the node index of q, or -1 if q is empty
+ */
+int AndOrDag::addWorkloadQuery(const std::string &q, size_t curFreq) {
+    size_t oldNumNodes = nodes.size();
+    int ret = addQuery(queryKey(q));
+    if (ret < 0)
+        return ret;
+    bool newWorkload = workloadFreq[ret] == 0;
+    freq[ret] += curFreq;
+    workloadFreq[ret] += curFreq;
+    if (auxInit)
+        growAuxiliary(oldNumNodes);
+    if (planned) {
+        for (size_t i = oldNumNodes; i < nodes.size(); i++)
+            if (nodes[i].getChildIdx().empty())
+                annotateLeaf(i);
+        planNode(ret);
+        if (useViewMatch)
+            matchViews(oldNumNodes);
+        propagateFreq(ret, curFreq);
+        if (newWorkload)
+            propagateUseCnt(ret, 1);
+    }
+    return ret;
 }
 
+/**
+ * @brief Parse q once and add its syntax tree to the dag. Each sub-expression (an AST node, or a range of the
+ * elements of a concatenation, which has a concat op node per split) is interned by its operator and the
+ * expression ids of its operands, so sub-expressions shared with earlier queries are found without printing
+ * or re-parsing them.
+ *
+ * To implement cost estimation for concat and kleene, need to record start/end labels
+ * Alternation: union of all child nodes' start/end labels (therefore needs to be vector)
+ * Concat: start label of first child, end label of last child
+ * Kleene: start label of child, end label of child
+ * ?: start label of child, end label of child
+ * Base case: start label = end label = current label
+ */
 int AndOrDag::addQuery(const std::string &q) {
     if (q.empty())
         return -1;
     const auto &it = q2idx.find(q);
-    if (q2idx.find(q) != q2idx.end())
+    if (it != q2idx.end())
         return it->second;
-    
-    istringstream ifs(q);
-    RpqErrorListener lstnr;
-    antlr4::ANTLRInputStream input(ifs);
-    rpqLexer lexer(&input);
-    lexer.removeErrorListeners();
-    lexer.addErrorListener(&lstnr);
-    antlr4::CommonTokenStream tokens(&lexer);
-    rpqParser parser(&tokens);
-    parser.removeErrorListeners();
-    parser.addErrorListener(&lstnr);
-    rpqParser::PathContext *path = parser.path();
-    
-    // To implement cost estimation for concat and kleene, need to record start/end labels
-    // Alternation: union of all child nodes' start/end labels (therefore needs to be vector)
-    // Concat: start label of first child, end label of last child
-    // Kleene: start label of child, end label of child
-    // ?: start label of child, end label of child
-    // Base case: start label = end label = current label
-    addNode(true, 0);
-    size_t ret = nodes.size() - 1, tmpIdx = 0;
-    const auto &pathSequenceVec = path->pathSequence();
-    if (pathSequenceVec.size() > 1) {
-        addNode(false, 0);
-        tmpIdx = nodes.size() - 1;
-        addParentChild(ret, tmpIdx);
-        for (const auto &pathSequence : pathSequenceVec) {
-            size_t curRet = addQuery(pathSequence->getText());
-            addParentChild(tmpIdx, curRet);
-            nodes[ret].addStartLabel(nodes[curRet].getStartLabel());
-            nodes[ret].addEndLabel(nodes[curRet].getEndLabel());
-        }
-        q2idx[q] = ret;
-        return ret;
+
+    RpqAst ast;
+    ast.parse(q);
+    const auto &astNodes = ast.getNodes();
+    vector<size_t> astExpr(astNodes.size()), key;
+    // Children precede their parents in the arena
+    for (size_t i = 0; i < astNodes.size(); i++) {
+        key.assign(1, astNodes[i].type);
+        if (astNodes[i].type == 'l') {
+            key.emplace_back(astNodes[i].lbl);
+            key.emplace_back(astNodes[i].inv);
+        } else
+            for (size_t j = 0; j < astNodes[i].numChildren; j++)
+                key.emplace_back(astExpr[ast.getChildren(i)[j]]);
+        astExpr[i] = internExpr(key);
     }
-    const auto &pathEltVec = pathSequenceVec[0]->pathElt();
-    if (pathEltVec.size() > 1) {
-        size_t sz = pathEltVec.size();
-        string lStr = pathEltVec[0]->getText(), rStr = pathEltVec[1]->getText();
-        for (size_t i = 2; i < sz; i++) {
-            rStr += "/";
-            rStr += pathEltVec[i]->getText();
-        }
-        for (size_t i = 0; i < sz - 1; i++) {
-            addNode(false, 1);
-            tmpIdx = nodes.size() - 1;
-            addParentChild(ret, tmpIdx);
-            size_t lRet = addQuery(lStr);
-            size_t rRet = addQuery(rStr);
-            addParentChild(tmpIdx, lRet);
-            addParentChild(tmpIdx, rRet);
-            if (i == 0)
-                nodes[ret].addStartLabel(nodes[lRet].getStartLabel());
-            if (i != sz - 2) {
-                lStr += "/" + pathEltVec[i + 1]->getText();
-                rStr = rStr.substr(rStr.find('/') + 1);
-            } else
-                nodes[ret].addEndLabel(nodes[rRet].getEndLabel());
-        }
+    size_t ret = addAstNode(ast, ast.getRoot(), astExpr);
+    // Also key q as written (e.g., with redundant parentheses), unless all of it is one parenthesized group
+    size_t depth = 0, i = 0;
+    for (; i < q.size(); i++) {
+        if (q[i] == '(')
+            depth++;
+        else if (q[i] == ')' && --depth == 0)
+            break;
+    }
+    if (q[0] != '(' || i + 1 < q.size())
         q2idx[q] = ret;
+    return ret;
+}
+
+size_t AndOrDag::internExpr(const std::vector<size_t> &key) {
+    auto it = exprIds.find(key);
+    if (it != exprIds.end())
+        return it->second;
+    size_t ret = exprIds.size();
+    exprIds.emplace(key, ret);
+    expr2idx.emplace_back(-1);
+    return ret;
+}
+
+// The eq node of the expression named text; found tells whether it was already in the dag
+size_t AndOrDag::addEqNode(size_t exprId, const std::string &text, bool &found) {
+    // Dags built by hand only have q2idx
+    auto it = q2idx.find(text);
+    found = it != q2idx.end();
+    if (found) {
+        expr2idx[exprId] = it->second;
+        return it->second;
+    }
+    addNode(true, 0);
+    size_t ret = nodes.size() - 1;
+    q2idx[text] = ret;
+    expr2idx[exprId] = ret;
+    return ret;
+}
+
+size_t AndOrDag::addAstNode(RpqAst &ast, size_t astIdx, const std::vector<size_t> &astExpr) {
+    const auto &astNode = ast.getNodes()[astIdx];
+    if (astNode.type == '/')
+        return addConcat(ast, ast.getChildren(astIdx), 0, astNode.numChildren - 1, astExpr);
+    size_t exprId = astExpr[astIdx];
+    if (expr2idx[exprId] >= 0)
+        return expr2idx[exprId];
+    bool found = false;
+    size_t ret = addEqNode(exprId, ast.toString(astIdx), found);
+    if (found)
+        return ret;
+    if (astNode.type == 'l') {
+        nodes[ret].addStartLabel(astNode.lbl, astNode.inv);
+        nodes[ret].addEndLabel(astNode.lbl, astNode.inv);
         return ret;
     }
-    const auto &pathMod = pathEltVec[0]->pathMod();
-    if (!pathMod) {
-        if (pathEltVec[0]->pathPrimary()->path()) {
-            nodes.pop_back();
-            ret = addQuery(pathEltVec[0]->pathPrimary()->path()->getText());
-            return ret;
-        } else {
-            q2idx[q] = ret;
-            bool isInv = q[q.size() - 2] == '-';
-            double curLbl = stod(q.substr(1, q.size() - 2 - (isInv ? 1 : 0)));
-            nodes[ret].addStartLabel(curLbl, isInv);
-            nodes[ret].addEndLabel(curLbl, isInv);
-            return ret;
-        }
-    } else {
-        string pathModStr = pathMod->getText();
-        tmpIdx = nodes.size();
-        if (pathModStr == "?")
-            addNode(false, 4);
-        else if (pathModStr == "*")
-            addNode(false, 2);
-        else if (pathModStr == "+")
-            addNode(false, 3);
-        addParentChild(ret, tmpIdx);
-        if (pathEltVec[0]->pathPrimary()->path()) {
-            size_t curRet = addQuery(pathEltVec[0]->pathPrimary()->path()->getText());
-            addParentChild(tmpIdx, curRet);
-            nodes[ret].addStartLabel(nodes[curRet].getStartLabel());
-            nodes[ret].addEndLabel(nodes[curRet].getEndLabel());
-        }
-        else {
-            addNode(true, 0);
-            addParentChild(tmpIdx, nodes.size() - 1);
-            q2idx[pathEltVec[0]->pathPrimary()->getText()] = nodes.size() - 1;
-            bool isInv = q[q.size() - 3] == '-';
-            double curLbl = stod(q.substr(1, q.size() - 3 - (isInv ? 1 : 0)));
-            nodes.back().addStartLabel(curLbl, isInv);
-            nodes.back().addEndLabel(curLbl, isInv);
-            nodes[ret].addStartLabel(curLbl, isInv);
-            nodes[ret].addEndLabel(curLbl, isInv);
-        }
-        q2idx[q] = ret;
+    size_t tmpIdx = nodes.size();
+    if (astNode.type == '|')
+        addNode(false, 0);
+    else if (astNode.type == '*')
+        addNode(false, 2);
+    else if (astNode.type == '+')
+        addNode(false, 3);
+    else
+        addNode(false, 4);
+    addParentChild(ret, tmpIdx);
+    for (size_t i = 0; i < astNode.numChildren; i++) {
+        size_t curRet = addAstNode(ast, ast.getChildren(astIdx)[i], astExpr);
+        addParentChild(tmpIdx, curRet);
+        nodes[ret].addStartLabel(nodes[curRet].getStartLabel());
+        nodes[ret].addEndLabel(nodes[curRet].getEndLabel());
+    }
+    return ret;
+}
+
+// The eq node of the concatenation of the elements eltIdx[from..to], with a concat op node per split
+size_t AndOrDag::addConcat(RpqAst &ast, const size_t *eltIdx, size_t from, size_t to, const std::vector<size_t> &astExpr) {
+    if (from == to)
+        return addAstNode(ast, eltIdx[from], astExpr);
+    vector<size_t> key(1, '/');
+    for (size_t i = from; i <= to; i++)
+        key.emplace_back(astExpr[eltIdx[i]]);
+    size_t exprId = internExpr(key);
+    if (expr2idx[exprId] >= 0)
+        return expr2idx[exprId];
+    bool found = false;
+    size_t ret = addEqNode(exprId, ast.toString(eltIdx, from, to), found);
+    if (found)
         return ret;
+    for (size_t i = from; i < to; i++) {
+        size_t tmpIdx = nodes.size();
+        addNode(false, 1);
+        addParentChild(ret, tmpIdx);
+        size_t lRet = addConcat(ast, eltIdx, from, i, astExpr);
+        size_t rRet = addConcat(ast, eltIdx, i + 1, to, astExpr);
+        addParentChild(tmpIdx, lRet);
+        addParentChild(tmpIdx, rRet);
+        if (i == from)
+            nodes[ret].addStartLabel(nodes[lRet].getStartLabel());
+        if (i == to - 1)
+            nodes[ret].addEndLabel(nodes[rRet].getEndLabel());
     }
+    return ret;
 }
 
 void AndOrDag::initAuxiliary() {
@@ -138,12 +214,61 @@ void AndOrDag::initAuxiliary() {
     idx2q.assign(numNodes, "");
     for (const auto &pr : q2idx)
         idx2q[pr.second] = pr.first;
+    fillLeafQueries(0);
     materialized.assign(numNodes, false);
     cost.assign(numNodes, 0);
     srcCnt.assign(numNodes, 0);
     dstCnt.assign(numNodes, 0);
     card.assign(numNodes, 0);
     topoSort();
+    auxInit = true;
+}
+
+void AndOrDag::growAuxiliary(size_t oldNumNodes) {
+    size_t numNodes = nodes.size();
+    if (numNodes == oldNumNodes)
+        return;
+    idx2q.resize(numNodes);
+    for (const auto &pr : q2idx)
+        if (pr.second >= oldNumNodes)
+            idx2q[pr.second] = pr.first;
+    fillLeafQueries(oldNumNodes);
+    materialized.resize(numNodes, false);
+    cost.resize(numNodes, 0);
+    srcCnt.resize(numNodes, 0);
+    dstCnt.resize(numNodes, 0);
+    card.resize(numNodes, 0);
+    // The parents of new nodes are all new, so the new nodes (sorted among themselves) precede the old ones
+    vector<size_t> parentCnt(numNodes - oldNumNodes, 0), newSeq;
+    queue<size_t> q;
+    for (size_t i = oldNumNodes; i < numNodes; i++) {
+        parentCnt[i - oldNumNodes] = nodes[i].getParentIdx().size();
+        if (parentCnt[i - oldNumNodes] == 0)
+            q.push(i);
+    }
+    while (!q.empty()) {
+        size_t curIdx = q.front();
+        q.pop();
+        newSeq.emplace_back(curIdx);
+        for (size_t childIdx : nodes[curIdx].getChildIdx())
+            if (childIdx >= oldNumNodes && --parentCnt[childIdx - oldNumNodes] == 0)
+                q.push(childIdx);
+    }
+    assert(newSeq.size() == numNodes - oldNumNodes);
+    topoSeq.insert(topoSeq.begin(), newSeq.begin(), newSeq.end());
+    for (size_t i = 0; i < numNodes; i++)
+        nodes[topoSeq[i]].setTopoOrder(i);
+}
+
+// Name the leaves missing from q2idx, e.g., duplicate leaves of a label in a dag built by hand
+void AndOrDag::fillLeafQueries(size_t fromIdx) {
+    size_t numNodes = nodes.size();
+    for (size_t i = fromIdx; i < numNodes; i++) {
+        if (!idx2q[i].empty() || !nodes[i].getChildIdx().empty() || nodes[i].getStartLabel().empty())
+            continue;
+        const auto &sl = nodes[i].getStartLabel()[0];
+        idx2q[i] = "<" + to_string(size_t(sl.lbl)) + (sl.inv ? "->" : ">");
+    }
 }
 
 void AndOrDag::annotateLeafCostCard() {
@@ -174,60 +299,189 @@ void AndOrDag::annotateLeafCostCard() {
             card[idx] = csrPtr->outCsr[i].m;
         }
     }
+    // Leaves missing from q2idx (see fillLeafQueries)
+    size_t numNodes = nodes.size();
+    for (size_t idx = 0; idx < numNodes; idx++)
+        if (nodes[idx].getChildIdx().empty() && cost[idx] == 0)
+            annotateLeaf(idx);
 }
 
+// Annotate a single leaf node, as annotateLeafCostCard does for all
+void AndOrDag::annotateLeaf(size_t idx) {
+    const auto &sl = nodes[idx].getStartLabel()[0];
+    auto it = csrPtr->label2idx.find(sl.lbl);
+    if (it == csrPtr->label2idx.end())
+        return;
+    size_t i = it->second;
+    srcCnt[idx] = sl.inv ? csrPtr->inCsr[i].n : csrPtr->outCsr[i].n;
+    dstCnt[idx] = sl.inv ? csrPtr->outCsr[i].n : csrPtr->inCsr[i].n;
+    cost[idx] = csrPtr->outCsr[i].m;
+    card[idx] = csrPtr->outCsr[i].m;
+}
+
+/**
+ * @brief Plan the nodes reachable from those with freq > 0, level by level from the leaves
+ * (level = height above the leaves). The nodes of a level only read their children, which are
+ * in lower levels, so each level is planned in parallel.
+ */
 void AndOrDag::plan() {
     if (!csrPtr) {
         cerr << "Please set CSR pointer before calling plan()" << endl;
         return;
     }
+    ensureTopoOrder();
     size_t numNodes = nodes.size();
-    for (size_t i = 0; i < numNodes; i++) {
+    vector<bool> needPlan(numNodes, false);
+    for (size_t i = 0; i < numNodes; i++)
         if (freq[i] > 0)
-            planNode(i);
+            needPlan[i] = true;
+    for (size_t idx : topoSeq) {
+        if (needPlan[idx])
+            for (size_t childIdx : nodes[idx].getChildIdx())
+                needPlan[childIdx] = true;
+    }
+    vector<size_t> height(numNodes, 0);
+    vector<vector<size_t>> levels;
+    for (auto it = topoSeq.rbegin(); it != topoSeq.rend(); it++) {
+        size_t idx = *it;
+        if (!needPlan[idx])
+            continue;
+        for (size_t childIdx : nodes[idx].getChildIdx())
+            height[idx] = max(height[idx], height[childIdx] + 1);
+        if (height[idx] >= levels.size())
+            levels.resize(height[idx] + 1);
+        levels[height[idx]].emplace_back(idx);
     }
+    // Leaves only set their materialized flags (vector<bool> is not safe for concurrent writes)
+    if (!levels.empty())
+        for (size_t idx : levels[0])
+            planNodeFromChildren(idx);
+    planInParallel = true;  // Sampling inside the tasks runs serially
+    for (size_t h = 1; h < levels.size(); h++) {
+        const auto &level = levels[h];
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, level.size()), [this, &level](const tbb::blocked_range<size_t> &r) {
+            for (size_t i = r.begin(); i != r.end(); i++)
+                planNodeFromChildren(level[i]);
+        });
+    }
+    planInParallel = false;
+    if (useViewMatch)
+        matchViews();
     propagate();
+    planned = true;
 }
 
 void AndOrDag::propagate() {
     // Propagate freq & useCnt downwards only once from all root nodes (those without parents)
     size_t numNodes = nodes.size();
+    vector<pair<size_t, size_t>> freqSrc;
+    vector<pair<size_t, int>> useCntSrc;
     for (size_t i = 0; i < numNodes; i++) {
         if (nodes[i].getParentIdx().empty())
-            propagateFreq(i, freq[i]);
+            freqSrc.emplace_back(i, freq[i]);
         if (workloadFreq[i] > 0)
-            propagateUseCnt(i, 1);
+            useCntSrc.emplace_back(i, 1);
     }
+    propagateFreq(freqSrc);
+    propagateUseCnt(useCntSrc);
 }
 
 void AndOrDag::propagateFreq(size_t idx, size_t propVal) {
-    const auto &curChildIdx = nodes[idx].getChildIdx();
-    size_t numChild = curChildIdx.size();
-    if (numChild == 0)
-        return;
-    for (size_t i = 0; i < numChild; i++) {
-        freq[curChildIdx[i]] += propVal;
-        propagateFreq(curChildIdx[i], propVal);
+    propagateFreq({{idx, propVal}});
+}
+
+/**
+ * @brief Add each propVal to the descendants of its node once per path, as one pass in topological order:
+ * a node is visited once, after all its ancestors, with the sum of what reaches it
+ */
+void AndOrDag::propagateFreq(const std::vector<std::pair<size_t, size_t>> &idx2propVal) {
+    ensureTopoOrder();
+    priority_queue<int, vector<int>, greater<int>> pq;  // Topological orders of the nodes to visit
+    unordered_map<size_t, size_t> flow;
+    for (const auto &pr : idx2propVal) {
+        if (flow.emplace(pr.first, 0).second)
+            pq.push(nodes[pr.first].getTopoOrder());
+        flow[pr.first] += pr.second;
+    }
+    while (!pq.empty()) {
+        size_t idx = topoSeq[pq.top()];
+        pq.pop();
+        size_t propVal = flow[idx];
+        flow.erase(idx);
+        if (propVal == 0)
+            continue;
+        for (size_t childIdx : nodes[idx].getChildIdx()) {
+            freq[childIdx] += propVal;
+            auto it = flow.find(childIdx);
+            if (it == flow.end()) {
+                flow.emplace(childIdx, propVal);
+                pq.push(nodes[childIdx].getTopoOrder());
+            } else
+                it->second += propVal;
+        }
     }
 }
 
 void AndOrDag::propagateUseCnt(size_t idx, int delta) {
-    useCnt[idx] += delta;
-    if (materialized[idx])
-        return;
-    const auto &curChildIdx = nodes[idx].getChildIdx();
-    size_t numChild = curChildIdx.size();
-    if (numChild == 0)
-        return;
-    if (nodes[idx].getIsEq() && numChild > 1)
-        propagateUseCnt(nodes[idx].getTargetChild(), delta);
-    else {
-        for (size_t i = 0; i < numChild; i++)
-            propagateUseCnt(curChildIdx[i], delta);
+    propagateUseCnt({{idx, delta}});
+}
+
+/**
+ * @brief Add each delta to the useCnt of its node and, through non-materialized nodes, of the descendants
+ * it is used by (only the target child of an eq node), once per path. As in propagateFreq, each affected
+ * node is visited once in topological order with its accumulated delta.
+ */
+void AndOrDag::propagateUseCnt(const std::vector<std::pair<size_t, int>> &idx2delta) {
+    ensureTopoOrder();
+    priority_queue<int, vector<int>, greater<int>> pq;
+    unordered_map<size_t, int> acc;
+    for (const auto &pr : idx2delta) {
+        if (acc.emplace(pr.first, 0).second)
+            pq.push(nodes[pr.first].getTopoOrder());
+        acc[pr.first] += pr.second;
+    }
+    while (!pq.empty()) {
+        size_t idx = topoSeq[pq.top()];
+        pq.pop();
+        int delta = acc[idx];
+        acc.erase(idx);
+        useCnt[idx] += delta;
+        if (delta == 0 || materialized[idx])
+            continue;
+        const auto &curChildIdx = nodes[idx].getChildIdx();
+        size_t numChild = curChildIdx.size();
+        for (size_t i = 0; i < numChild; i++) {
+            size_t childIdx = curChildIdx[i];
+            if (nodes[idx].getIsEq() && numChild > 1) {
+                if (i > 0)
+                    break;
+                childIdx = nodes[idx].getTargetChild();
+            }
+            auto it = acc.find(childIdx);
+            if (it == acc.end()) {
+                acc.emplace(childIdx, delta);
+                pq.push(nodes[childIdx].getTopoOrder());
+            } else
+                it->second += delta;
+        }
     }
 }
 
+void AndOrDag::ensureTopoOrder() {
+    if (topoSeq.size() != nodes.size())
+        topoSort();
+}
+
 void AndOrDag::planNode(size_t nodeIdx) {
+    if (cost[nodeIdx] != 0)
+        return;
+    for (size_t childIdx : nodes[nodeIdx].getChildIdx())
+        planNode(childIdx);
+    planNodeFromChildren(nodeIdx);
+}
+
+// Plan a node whose children are already planned
+void AndOrDag::planNodeFromChildren(size_t nodeIdx) {
     if (cost[nodeIdx] != 0)
         return;
     auto &curNode = nodes[nodeIdx];
@@ -237,8 +491,6 @@ void AndOrDag::planNode(size_t nodeIdx) {
         materialized[nodeIdx] = true;
         return;
     }
-    for (size_t i = 0; i < numChild; i++)
-        planNode(curChildIdx[i]);
     bool isEq = curNode.getIsEq();
     if (isEq) {
         size_t targetChild = curChildIdx[0];
@@ -281,7 +533,7 @@ void AndOrDag::planNode(size_t nodeIdx) {
             } else {
                 float plan1 = 0, plan2 = 0;
                 float cost1 = cost[lChild], cost2 = cost[rChild];
-                float middleDivIn = approxMiddleDivInMonteCarlo(nodes[lChild].getEndLabel(), rChild);
+                float middleDivIn = estimateMiddleDivIn(nodes[lChild].getEndLabel(), rChild);
                 card[nodeIdx] = middleDivIn * card[lChild] * card[rChild] / srcCnt[rChild];
                 size_t joinSetSz = dstCnt[lChild] * middleDivIn;
                 plan1 = cost1 + cost2 * joinSetSz / srcCnt[rChild];
@@ -301,7 +553,7 @@ void AndOrDag::planNode(size_t nodeIdx) {
             } else {
                 srcCnt[nodeIdx] = srcCnt[curChild];
                 dstCnt[nodeIdx] = dstCnt[curChild];
-                float middleDivIn = approxMiddleDivInMonteCarlo(nodes[curChild].getEndLabel(), curChild);
+                float middleDivIn = estimateMiddleDivIn(nodes[curChild].getEndLabel(), curChild);
                 float c = middleDivIn * card[curChild] / srcCnt[curChild];  // c is NAN when srcCnt[curChild] == 0
                 size_t d = 1;
                 float curC = c;
@@ -351,6 +603,7 @@ void AndOrDag::topoSort() {
     // Maintain #parents of each node, take those with 0 as sorted, subtract 1 from its children's number
     size_t numNodes = nodes.size();
     vector<size_t> parentCnt(numNodes, 0);
+    topoSeq.assign(numNodes, 0);
     size_t numDone = 0;
     int curOrder = 0;
     queue<size_t> q;
@@ -364,6 +617,7 @@ void AndOrDag::topoSort() {
         curIdx = q.front();
         q.pop();
         nodes[curIdx].setTopoOrder(curOrder);
+        topoSeq[curOrder] = curIdx;
         curOrder++;
         numDone++;
         const auto &curChildIdx = nodes[curIdx].getChildIdx();
@@ -376,119 +630,87 @@ void AndOrDag::topoSort() {
     assert(numDone == numNodes);
 }
 
-void AndOrDag::replanWithMaterialize(const std::vector<size_t> &matIdx,
-std::unordered_map<size_t, float> &node2cost, float &reducedCost) {
-    node2cost.clear();
-    reducedCost = 0;
-    // matIdx & topoOrder
-    priority_queue<pair<size_t, size_t>, vector<pair<size_t, size_t>>, decltype(&PairSecondLess<size_t, size_t>)> pq(PairSecondLess);
-    for (size_t idx : matIdx)
-        pq.emplace(idx, nodes[idx].getTopoOrder());
-    while (!pq.empty()) {
-        size_t curIdx = pq.top().first;
-        pq.pop();
-        updateNodeCost(curIdx, node2cost, reducedCost);
-    }
-}
-
-void AndOrDag::applyChanges(const std::vector<size_t> &matIdx, const std::unordered_map<size_t, float> &node2cost, bool updateUseCnt) {
-    for (const auto &pr : node2cost) {
-        size_t nodeIdx = pr.first;
-        cost[nodeIdx] = pr.second;
-        // For eq nodes with multiple / op children, update targetChild if necessary
-        if (!nodes[nodeIdx].getIsEq() && nodes[nodeIdx].getOpType() == 1) {
-            const auto &parentIdx = nodes[nodeIdx].getParentIdx();
-            std::unordered_map<size_t, float>::const_iterator it;
-            for (size_t parent : parentIdx) {
-                it = node2cost.find(parent);
-                if (it != node2cost.end() && it->second == pr.second) {
-                    if (updateUseCnt) {
-                        size_t origTargetChild = nodes[parent].getTargetChild();
-                        propagateUseCnt(origTargetChild, 0 - useCnt[parent]);
-                        propagateUseCnt(nodeIdx, useCnt[parent]);
-                    }
-                    nodes[parent].setTargetChild(nodeIdx);
+/**
+ * @brief Replan the dag assuming the views in matIdx are materialized. Changed costs go upwards through a worklist
+ * in topological order, so each affected node is recomputed once from its children's final costs.
+ * Only reads the dag (and the estimate cache), so concurrent calls with different workspaces are safe. Unlike the
+ * former replanWithMaterialize, it does not set the Kleene execution modes in the nodes either: they are in res, and
+ * only applyChanges writes them, so candidates that are not chosen leave the modes of the plan unchanged.
+ */
+void AndOrDag::replan(const std::vector<size_t> &matIdx, ReplanWorkspace &ws, ReplanResult &res) {
+    ensureTopoOrder();
+    ws.reset(nodes.size());
+    res.node2cost.clear();
+    res.left2right.clear();
+    res.targetChild.clear();
+    res.reducedCost = 0;
+    auto curCost = [&](size_t idx) { return ws.costStamp[idx] == ws.epoch ? ws.newCost[idx] : cost[idx]; };
+    auto enqueue = [&](size_t idx) {
+        if (ws.queuedStamp[idx] == ws.epoch)
+            return;
+        ws.queuedStamp[idx] = ws.epoch;
+        ws.pending[idx] = nodes[idx].getIsEq() ? numeric_limits<float>::max() : 0;
+        ws.pendingChild[idx] = idx;
+        ws.worklist.push(nodes[idx].getTopoOrder());
+    };
+    for (size_t idx : matIdx) {
+        assert(nodes[idx].getIsEq());
+        enqueue(idx);
+        if (card[idx] < ws.pending[idx]) {
+            ws.pending[idx] = card[idx];
+            ws.pendingChild[idx] = idx;
+        }
+        // The view also answers the eq nodes of equivalent queries
+        if (idx < equivRoot.size())
+            for (size_t equivIdx : equivNodes[equivRoot[idx]]) {
+                if (materialized[equivIdx] || !canAnswer(idx, equivIdx))
+                    continue;
+                enqueue(equivIdx);
+                if (card[idx] < ws.pending[equivIdx]) {
+                    ws.pending[equivIdx] = card[idx];
+                    ws.pendingChild[equivIdx] = equivIdx;
                 }
             }
-        }
-    }
-    if (updateUseCnt) {
-        size_t tmpUseCnt = 0;
-        for (size_t idx : matIdx) {
-            tmpUseCnt = useCnt[idx];
-            propagateUseCnt(idx, 0 - tmpUseCnt);
-            useCnt[idx] = tmpUseCnt;
-        }
     }
-}
 
-// Do not update srcCnt, dstCnt, card
-void AndOrDag::updateNodeCost(size_t nodeIdx, std::unordered_map<size_t, float> &node2cost,
-float &reducedCost, float updateCost) {
-    float realUpdateCost = updateCost < 0 ? card[nodeIdx] : updateCost;
-    float prevCost = node2cost.find(nodeIdx) == node2cost.end() ? cost[nodeIdx] : node2cost[nodeIdx];
-    if (realUpdateCost >= prevCost)
-        return;
-    float deltaCost = prevCost - realUpdateCost;
-    if (workloadFreq[nodeIdx])
-        reducedCost += (prevCost - realUpdateCost) * float(workloadFreq[nodeIdx]);
-    node2cost[nodeIdx] = realUpdateCost;
-    const auto &curParentIdx = nodes[nodeIdx].getParentIdx();
-    if (curParentIdx.empty())
-        return;
-    bool curIsEq = nodes[curParentIdx[0]].getIsEq();
-    if (curIsEq) {
-        for (size_t parentIdx : curParentIdx) {
-            float parentPrevCost = node2cost.find(parentIdx) == node2cost.end() ? cost[parentIdx] : node2cost[parentIdx];
-            if (realUpdateCost < parentPrevCost)
-                updateNodeCost(parentIdx, node2cost, reducedCost, realUpdateCost);
-        }
-    } else {
-        // Parents are op nodes, use cost model to update cost
-        for (size_t parentIdx : curParentIdx) {
-            char parentOpType = nodes[parentIdx].getOpType();
-            float parentPrevCost = node2cost.find(parentIdx) == node2cost.end() ? cost[parentIdx] : node2cost[parentIdx];
-            float parentUpdateCost = 0;
-            if (parentOpType == 0 || parentOpType == 4)
-                updateNodeCost(parentIdx, node2cost, reducedCost, parentPrevCost - deltaCost);
-            else if (parentOpType == 1) {
-                size_t lChild = 0, rChild = 0;
-                const auto &curSiblingIdx = nodes[parentIdx].getChildIdx();
-                if (curSiblingIdx[0] == nodeIdx) {
-                    lChild = nodeIdx;
-                    rChild = curSiblingIdx[1];
-                }
-                else {
-                    lChild = curSiblingIdx[0];
-                    rChild = nodeIdx;
-                }
-                // TODO: cache joinSetSz if resampling is slow
-                float plan1 = 0, plan2 = 0;
-                float cost1 = node2cost.find(lChild) == node2cost.end() ? cost[lChild] : node2cost[lChild];
-                float cost2 = node2cost.find(rChild) == node2cost.end() ? cost[rChild] : node2cost[rChild];
+    while (!ws.worklist.empty()) {
+        size_t nodeIdx = topoSeq[ws.worklist.top()];
+        ws.worklist.pop();
+        float prevCost = curCost(nodeIdx), updateCost = prevCost;
+        const auto &curChildIdx = nodes[nodeIdx].getChildIdx();
+        if (nodes[nodeIdx].getIsEq())
+            updateCost = ws.pending[nodeIdx];
+        else {
+            char opType = nodes[nodeIdx].getOpType();
+            if (opType == 0 || opType == 4)
+                updateCost = prevCost - ws.pending[nodeIdx];
+            else if (opType == 1) {
+                size_t lChild = curChildIdx[0], rChild = curChildIdx[1];
+                float cost1 = curCost(lChild), cost2 = curCost(rChild);
                 if (card[lChild] == 0 || srcCnt[lChild] == 0 || dstCnt[lChild] == 0 \
                 || card[rChild] == 0 || srcCnt[rChild] == 0 || dstCnt[rChild] == 0)
-                    parentUpdateCost = cost1 < cost2 ? cost1 : cost2;
+                    updateCost = cost1 < cost2 ? cost1 : cost2;
                 else {
-                    float middleDivIn = approxMiddleDivInMonteCarlo(nodes[lChild].getEndLabel(), rChild);
+                    float middleDivIn = estimateMiddleDivIn(nodes[lChild].getEndLabel(), rChild);
                     size_t joinSetSz = dstCnt[lChild] * middleDivIn;
-                    plan1 = cost1 + cost2 * joinSetSz / srcCnt[rChild];
-                    plan2 = cost2 + cost1 * middleDivIn;
-                    parentUpdateCost = (plan1 < plan2 ? plan1 : plan2) + card[lChild] + card[rChild];
+                    float plan1 = cost1 + cost2 * joinSetSz / srcCnt[rChild];
+                    float plan2 = cost2 + cost1 * middleDivIn;
+                    updateCost = (plan1 < plan2 ? plan1 : plan2) + card[lChild] + card[rChild];
                 }
-                updateNodeCost(parentIdx, node2cost, reducedCost, parentUpdateCost);
-            } else if (parentOpType == 2 || parentOpType == 3) {
-                if (card[nodeIdx] == 0 || srcCnt[nodeIdx] == 0 || dstCnt[nodeIdx] == 0)
-                    updateNodeCost(parentIdx, node2cost, reducedCost, realUpdateCost);  // parent's cost equal to child's
+            } else if (opType == 2 || opType == 3) {
+                size_t childIdx = curChildIdx[0];
+                float childCost = curCost(childIdx);
+                if (card[childIdx] == 0 || srcCnt[childIdx] == 0 || dstCnt[childIdx] == 0)
+                    updateCost = childCost;  // cost equal to child's
                 else {
-                    float middleDivIn = approxMiddleDivInMonteCarlo(nodes[nodeIdx].getEndLabel(), nodeIdx);
-                    float c = middleDivIn * card[nodeIdx] / srcCnt[nodeIdx];
+                    float middleDivIn = estimateMiddleDivIn(nodes[childIdx].getEndLabel(), childIdx);
+                    float c = middleDivIn * card[childIdx] / srcCnt[childIdx];
                     size_t d = 1;
                     float curC = c;
                     if (c >= 1)
                         d = 6;
                     else {
-                        size_t curCard = c * card[nodeIdx];
+                        size_t curCard = c * card[childIdx];
                         while (curCard != 0) {
                             curCard *= c;
                             d++;
@@ -496,25 +718,90 @@ float &reducedCost, float updateCost) {
                         }
                     }
                     if (d == 1)
-                        parentUpdateCost = cost[nodeIdx];
+                        updateCost = cost[childIdx];
                     else {
                         float coeff = (1. - curC) / (1. - c);
-                        parentUpdateCost = (d - 1) * float(dstCnt[nodeIdx]) * middleDivIn / float(srcCnt[nodeIdx]);
+                        updateCost = (d - 1) * float(dstCnt[childIdx]) * middleDivIn / float(srcCnt[childIdx]);
                         // Annotate execution modes of Kleene
-                        if (realUpdateCost < card[nodeIdx]) {
-                            nodes[parentIdx].setLeft2Right(false);
-                            parentUpdateCost *= realUpdateCost;
-                        } else {
-                            nodes[parentIdx].setLeft2Right(true);
-                            parentUpdateCost *= card[nodeIdx];
-                        }
-                        // nodes[parentIdx].setLeft2Right(true);
-                        parentUpdateCost += realUpdateCost + (d - 1 + coeff) * card[nodeIdx];
+                        bool left2right = childCost >= card[childIdx];
+                        res.left2right.emplace_back(nodeIdx, left2right);
+                        updateCost *= left2right ? card[childIdx] : childCost;
+                        updateCost += childCost + (d - 1 + coeff) * card[childIdx];
                     }
-                    updateNodeCost(parentIdx, node2cost, reducedCost, parentUpdateCost);
                 }
             }
         }
+        if (updateCost >= prevCost)
+            continue;
+
+        if (workloadFreq[nodeIdx])
+            res.reducedCost += (prevCost - updateCost) * float(workloadFreq[nodeIdx]);
+        ws.newCost[nodeIdx] = updateCost;
+        ws.costStamp[nodeIdx] = ws.epoch;
+        res.node2cost.emplace_back(nodeIdx, updateCost);
+        if (nodes[nodeIdx].getIsEq() && ws.pendingChild[nodeIdx] != nodeIdx)
+            res.targetChild.emplace_back(nodeIdx, ws.pendingChild[nodeIdx]);
+        bool isConcat = !nodes[nodeIdx].getIsEq() && nodes[nodeIdx].getOpType() == 1;
+        for (size_t parentIdx : nodes[nodeIdx].getParentIdx()) {
+            enqueue(parentIdx);
+            if (nodes[parentIdx].getIsEq()) {
+                if (updateCost < ws.pending[parentIdx]) {
+                    ws.pending[parentIdx] = updateCost;
+                    ws.pendingChild[parentIdx] = isConcat ? nodeIdx : parentIdx;
+                }
+            } else if (nodes[parentIdx].getOpType() == 0 || nodes[parentIdx].getOpType() == 4)
+                ws.pending[parentIdx] += prevCost - updateCost;
+        }
+    }
+}
+
+void AndOrDag::replanCandidates(const std::vector<size_t> &candIdx, std::vector<ReplanResult> &results) {
+    ensureTopoOrder();
+    results.resize(candIdx.size());
+    planInParallel = true;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, candIdx.size()), [&](const tbb::blocked_range<size_t> &r) {
+        ReplanWorkspace &ws = replanWs.local();
+        for (size_t i = r.begin(); i != r.end(); i++)
+            replan({candIdx[i]}, ws, results[i]);
+    });
+    planInParallel = false;
+}
+
+void AndOrDag::applyChanges(const std::vector<size_t> &matIdx, const ReplanResult &res, bool updateUseCnt) {
+    for (const auto &pr : res.node2cost)
+        cost[pr.first] = pr.second;
+    for (const auto &pr : res.left2right)
+        nodes[pr.first].setLeft2Right(pr.second);
+    // For eq nodes with multiple op children, update targetChild
+    for (const auto &pr : res.targetChild) {
+        size_t parent = pr.first, nodeIdx = pr.second;
+        if (updateUseCnt) {
+            size_t origTargetChild = nodes[parent].getTargetChild();
+            propagateUseCnt(origTargetChild, 0 - useCnt[parent]);
+            propagateUseCnt(nodeIdx, useCnt[parent]);
+        }
+        nodes[parent].setTargetChild(nodeIdx);
+    }
+    if (updateUseCnt) {
+        size_t tmpUseCnt = 0;
+        for (size_t idx : matIdx) {
+            tmpUseCnt = useCnt[idx];
+            propagateUseCnt(idx, 0 - tmpUseCnt);
+            useCnt[idx] = tmpUseCnt;
+        }
+        // Equivalent queries now answered by the views use them instead of their own plans
+        for (size_t idx : matIdx) {
+            if (idx >= equivRoot.size())
+                continue;
+            for (size_t equivIdx : equivNodes[equivRoot[idx]]) {
+                if (materialized[equivIdx] || !canAnswer(idx, equivIdx) || cost[equivIdx] != card[idx])
+                    continue;
+                tmpUseCnt = useCnt[equivIdx];
+                propagateUseCnt(equivIdx, 0 - tmpUseCnt);
+                useCnt[equivIdx] = tmpUseCnt;
+                useCnt[idx] += tmpUseCnt;
+            }
+        }
     }
 }
 
@@ -522,7 +809,8 @@ float &reducedCost, float updateCost) {
  * @brief Choose views to materialize given a space budget
  * 
  * @param mode 0: greedy, 1: top workloadFreq, 2: top freq, 3: top benefit upper bound (freq * (cost - card)),
- * 4: Kleene closures with top benefit upper bound, 5: top freq with redundancy removal
+ * 4: Kleene closures with top benefit upper bound, 5: top freq with redundancy removal. Only the replans of the
+ * chosen views are applied to the dag (costs, Kleene execution modes and target children)
  * @param spaceBudget space budget (#node pairs, estimated)
  * @param testOut for testing only
  * @return the total real benefit brought by materialization
@@ -532,11 +820,15 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
     usedSpace = 0;
     vector<size_t> vIdxAdded, vIdxRemoved;
     if (mode == 0) {
-        priority_queue<pair<size_t, float>, vector<pair<size_t, float>>, decltype(&PairSecondLess<size_t, float>)> pq(PairSecondLess);
+        InspectablePriorityQueue<pair<size_t, float>, decltype(&PairSecondLess<size_t, float>)> pq(PairSecondLess);
         size_t numNodes = nodes.size();
         for (size_t i = 0; i < numNodes; i++) {
             if (nodes[i].getIsEq() && !nodes[i].getChildIdx().empty()) {
                 float benefit = (cost[i] - card[i]) * float(freq[i]);
+                if (i < equivRoot.size())
+                    for (size_t equivIdx : equivNodes[equivRoot[i]])
+                        if (cost[equivIdx] > card[i] && canAnswer(i, equivIdx))
+                            benefit += (cost[equivIdx] - card[i]) * float(freq[equivIdx]);
                 pq.emplace(i, benefit);
             }
         }
@@ -549,9 +841,14 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
         //  If the real benefit >0, push it back into the heap. Otherwise, terminate.
         // Otherwise, materialize it.
         // Stopping condition: empty heap, or the top element has real benefit <= 0
+        // With replanBatch > 1, the stale candidates next in the heap are replanned in parallel together with the popped one;
+        // as replanning does not change the dag, the loop then consumes their results in the same order as serial replans
         vector<size_t> matIdx;
-        unordered_map<size_t, unordered_map<size_t, float>> node2costMap;
-        unordered_map<size_t, unordered_map<size_t, float>>::iterator it;
+        unordered_map<size_t, ReplanResult> candRes;
+        ReplanWorkspace &ws = replanWs.local();
+        vector<size_t> replanned(numNodes, 0);  // stateId in which the node was replanned ahead in a batch
+        vector<size_t> batchIdx;
+        vector<ReplanResult> batchRes;
         float realBenefit = 0, totalRealBenefit = 0;
         unordered_map<size_t, float> realBenefitMap;
         size_t addSpace = 0;
@@ -563,14 +860,23 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
                 *testOut += to_string(curIdx) + " ";
             #endif
             if (benefitComputed[curIdx] != stateId) {
-                matIdx = {curIdx};
-                it = node2costMap.find(curIdx);
-                if (it == node2costMap.end())
-                    node2costMap[curIdx] = unordered_map<size_t, float>();
-                else
-                    node2costMap[curIdx].clear();
-                realBenefit = 0;
-                replanWithMaterialize(matIdx, node2costMap[curIdx], realBenefit);
+                if (replanBatch > 1 && replanned[curIdx] != stateId) {
+                    batchIdx = {curIdx};
+                    pq.visitInOrder([&](const pair<size_t, float> &pr) {
+                        if (benefitComputed[pr.first] != stateId && replanned[pr.first] != stateId)
+                            batchIdx.emplace_back(pr.first);
+                        return batchIdx.size() < replanBatch;
+                    });
+                    replanCandidates(batchIdx, batchRes);
+                    for (size_t i = 0; i < batchIdx.size(); i++) {
+                        candRes[batchIdx[i]] = std::move(batchRes[i]);
+                        replanned[batchIdx[i]] = stateId;
+                    }
+                } else if (replanned[curIdx] != stateId) {
+                    matIdx = {curIdx};
+                    replan(matIdx, ws, candRes[curIdx]);
+                }
+                realBenefit = candRes[curIdx].reducedCost;
                 #ifdef TEST
                 if (testOut)
                     *testOut += "1 " + to_string(realBenefit) + " ";
@@ -587,12 +893,12 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
                 if (testOut)
                     *testOut += "0 0 ";
                 #endif
-                addSpace = card[curIdx];
+                addSpace = viewSpace(curIdx);
                 if (usedSpace + addSpace > spaceBudget)
                     continue;   // Continue to try other candidates
                 materialized[curIdx] = true;
                 usedSpace += addSpace;
-                applyChanges({curIdx}, node2costMap[curIdx]);
+                applyChanges({curIdx}, candRes[curIdx]);
                 stateId++;
                 totalRealBenefit += realBenefitMap[curIdx];
             }
@@ -631,7 +937,7 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
             if (testOut)
                 *testOut += to_string(curIdx) + " ";
             #endif
-            addSpace = card[curIdx];
+            addSpace = viewSpace(curIdx);
             if (usedSpace + addSpace > spaceBudget) {
                 #ifdef TEST
                 if (testOut)
@@ -647,15 +953,14 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
                 *testOut += "1 ";
             #endif
         }
-        unordered_map<size_t, float> node2cost;
-        float realBenefit = 0;
+        ReplanResult res;
         auto start_time = std::chrono::steady_clock::now();
-        replanWithMaterialize(matIdx, node2cost, realBenefit);
+        replan(matIdx, replanWs.local(), res);
         auto end_time = std::chrono::steady_clock::now();
         std::chrono::microseconds elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
         std::cout << "Replan time: " << elapsed_microseconds.count() << " us" << std::endl;
-        applyChanges(matIdx, node2cost);
-        return realBenefit;
+        applyChanges(matIdx, res);
+        return res.reducedCost;
     } else if (mode == 5) {
         // Top freq with redundancy removal
         priority_queue<pair<size_t, float>, vector<pair<size_t, float>>, decltype(&PairSecondLess<size_t, float>)> pq(PairSecondLess);
@@ -664,7 +969,8 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
             if (nodes[i].getIsEq() && !nodes[i].getChildIdx().empty())
                 pq.emplace(i, freq[i]);
         size_t addSpace = 0;
-        unordered_map<size_t, float> node2cost;
+        ReplanResult res;
+        ReplanWorkspace &ws = replanWs.local();
         float realBenefit = 0;
         unordered_map<size_t, float> node2benefit;
         unordered_set<size_t> curMatIdx;
@@ -680,7 +986,7 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
             if (testOut)
                 *testOut += to_string(curIdx) + " ";
             #endif
-            addSpace = card[curIdx];
+            addSpace = viewSpace(curIdx);
             if (usedSpace + addSpace > spaceBudget) {
                 #ifdef TEST
                 if (testOut)
@@ -692,8 +998,8 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
             if (testOut)
                 *testOut += "1 ";
             #endif
-            node2benefit[curIdx] = 0;
-            replanWithMaterialize({curIdx}, node2cost, node2benefit[curIdx]);
+            replan({curIdx}, ws, res);
+            node2benefit[curIdx] = res.reducedCost;
             // card == 0 will have 0 cost if their single-path descendants are materialized,
             // but materializing them is harmless since their real cardinality may be greater than 0 but not very large
             if (node2benefit[curIdx] == 0 && card[curIdx] > 0) {
@@ -703,7 +1009,7 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
             usedSpace += addSpace;
             realBenefit += node2benefit[curIdx];
             // cout << node2benefit[curIdx] << " " << realBenefit << endl;
-            applyChanges({curIdx}, node2cost, true);
+            applyChanges({curIdx}, res, true);
             materialized[curIdx] = true;
 
             idx2erase.clear();
@@ -712,7 +1018,7 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
                     // cout << "Skip2 " << idx << endl;
                     idx2erase.emplace_back(idx);
                     materialized[idx] = false;  // Do not need to propagate useCnt because == 0
-                    usedSpace -= card[idx];
+                    usedSpace -= viewSpace(idx);
                     realBenefit -= node2benefit[idx];
                 }
             }
@@ -735,12 +1041,132 @@ float AndOrDag::chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget,
 void AndOrDag::execute(const std::string &q, QueryResult &qr) {
     if (q.empty())
         return;
-    auto it = q2idx.find(q);
+    auto it = q2idx.find(queryKey(q));
     if (it == q2idx.end())
         return;
     executeNode(it->second, qr);
 }
 
+/**
+ * @brief Execute a query that need not be in the (planned) dag. Its sub-expressions already in the dag are
+ * reused with their plans and materialized views; the rest is added and planned temporarily, and removed
+ * after execution, leaving the dag (and the workload statistics) as before. Planning the new nodes also plans
+ * the old ones still unplanned (cost 0) below them, and matching views may merge classes of old nodes through new
+ * ones, so the plans of those and the classes are saved and restored. q itself is unkeyed even if it names an old
+ * node, and the estimates cached for the new nodes, recorded as they are added, are dropped with them.
+ */
+void AndOrDag::executeAdHoc(const std::string &q_, QueryResult &qr) {
+    if (q_.empty())
+        return;
+    string q = queryKey(q_);
+    auto it = q2idx.find(q);
+    if (it != q2idx.end()) {
+        executeNode(it->second, qr);
+        return;
+    }
+    if (!planned) {
+        cerr << "Please call plan() before calling executeAdHoc()" << endl;
+        return;
+    }
+    size_t oldNumNodes = nodes.size();
+    adHocFromIdx = oldNumNodes;
+    size_t ret = addQuery(q);
+    growAuxiliary(oldNumNodes);
+    for (size_t i = oldNumNodes; i < nodes.size(); i++)
+        if (nodes[i].getChildIdx().empty())
+            annotateLeaf(i);
+    // The old nodes planNode would visit: those reached from ret through unplanned nodes
+    struct SavedPlan {
+        size_t idx, targetChild;
+        bool left2right, materialized;
+        float cost;
+        size_t srcCnt, dstCnt, card;
+    };
+    vector<SavedPlan> saved;
+    vector<size_t> stk({ret});
+    unordered_set<size_t> seen({ret});
+    while (!stk.empty()) {
+        size_t idx = stk.back();
+        stk.pop_back();
+        if (cost[idx] != 0)
+            continue;
+        if (idx < oldNumNodes)
+            saved.push_back({idx, nodes[idx].getTargetChild(), nodes[idx].getLeft2Right(), materialized[idx], cost[idx],
+                srcCnt[idx], dstCnt[idx], card[idx]});
+        for (size_t childIdx : nodes[idx].getChildIdx())
+            if (seen.emplace(childIdx).second)
+                stk.emplace_back(childIdx);
+    }
+    planNode(ret);
+    vector<size_t> prevEquivRoot;
+    vector<vector<size_t>> prevEquivNodes;
+    vector<bool> prevNullable;
+    if (useViewMatch) {
+        prevEquivRoot = equivRoot;
+        prevEquivNodes = equivNodes;
+        prevNullable = nullable;
+        matchViews(oldNumNodes);
+    }
+    executeNode(ret, qr);
+    for (const auto &sp : saved) {
+        nodes[sp.idx].setTargetChild(sp.targetChild);
+        nodes[sp.idx].setLeft2Right(sp.left2right);
+        materialized[sp.idx] = sp.materialized;
+        cost[sp.idx] = sp.cost;
+        srcCnt[sp.idx] = sp.srcCnt;
+        dstCnt[sp.idx] = sp.dstCnt;
+        card[sp.idx] = sp.card;
+    }
+    q2idx.erase(q);   // A new spelling of an old node (see addQuery); the new nodes' keys go with them
+    removeNodesFrom(oldNumNodes);
+    if (useViewMatch) {
+        equivRoot = std::move(prevEquivRoot);
+        equivNodes = std::move(prevEquivNodes);
+        nullable = std::move(prevNullable);
+    }
+    adHocFromIdx = numeric_limits<size_t>::max();
+}
+
+void AndOrDag::removeNodesFrom(size_t numNodes) {
+    size_t numNew = nodes.size() - numNodes;
+    if (numNew == 0)
+        return;
+    for (size_t i = numNodes; i < nodes.size(); i++)
+        for (size_t childIdx : nodes[i].getChildIdx())
+            if (childIdx < numNodes)
+                nodes[childIdx].removeParentsFrom(numNodes);
+    // A node may have several keys (see addQuery)
+    for (auto it = q2idx.begin(); it != q2idx.end(); ) {
+        if (it->second >= numNodes)
+            it = q2idx.erase(it);
+        else
+            ++it;
+    }
+    // The interned expressions stay, so that the next query gets the same ids
+    for (auto &idx : expr2idx)
+        if (idx >= int(numNodes))
+            idx = -1;
+    nodes.erase(nodes.begin() + numNodes, nodes.end());
+    idx2q.resize(numNodes);
+    materialized.resize(numNodes);
+    cost.resize(numNodes);
+    srcCnt.resize(numNodes);
+    dstCnt.resize(numNodes);
+    card.resize(numNodes);
+    freq.resize(numNodes);
+    useCnt.resize(numNodes);
+    workloadFreq.resize(numNodes);
+    // The view-matching classes are restored by executeAdHoc, since new nodes may have merged old ones
+    // The new nodes precede the old ones in topoSeq (see growAuxiliary)
+    topoSeq.erase(topoSeq.begin(), topoSeq.begin() + numNew);
+    for (size_t i = 0; i < numNodes; i++)
+        nodes[topoSeq[i]].setTopoOrder(i);
+    // Estimates keyed by removed indices would be wrong for the nodes that reuse them
+    for (const auto &key : adHocEstimateKeys)
+        estimateCache.unsafe_erase(key);
+    adHocEstimateKeys.clear();
+}
+
 // Added no loop caching execution
 void AndOrDag::executeNode(size_t nodeIdx, QueryResult &qr, const std::unordered_set<size_t> *lCandPtr,
 const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatIdx) {
@@ -750,6 +1176,10 @@ const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatId
         // If current node materialized
         // Let AndOrDag take care of the memory deallocation
         if (materialized[nodeIdx] && curMatIdx != int(nodeIdx)) {
+            if (curNode.getReachIdxPtr()) {
+                executeReachIdxView(nodeIdx, qr, lCandPtr, rCandPtr, nlcResPtr);
+                return;
+            }
             if (nlcResPtr)
                 qr.assignAsJoin(*nlcResPtr, curNode.getRes());  // Join nlcRes with the materialized result, forgoing candidate filtering
             else {
@@ -758,6 +1188,24 @@ const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatId
             }
             return;
         }
+        int viewIdx = curMatIdx == int(nodeIdx) ? -1 : answeringView(nodeIdx);
+        if (viewIdx != -1) {
+            // Answer with the view of an equivalent query, adding back the empty path if the view lacks it
+            if (!nullable[nodeIdx] || nullable[viewIdx]) {
+                executeNode(viewIdx, qr, lCandPtr, rCandPtr, nlcResPtr);
+                return;
+            }
+            QueryResult viewQr(nullptr, false);
+            executeNode(viewIdx, viewQr, lCandPtr, rCandPtr);
+            viewQr.hasEpsilon = true;
+            if (nlcResPtr) {
+                qr.assignAsJoin(*nlcResPtr, viewQr);
+                if (viewQr.newed)
+                    delete viewQr.csrPtr;
+            } else
+                qr = viewQr;
+            return;
+        }
         if (curChildIdx.empty()) {
             // Single label
             // Implements candidate filtering
@@ -869,7 +1317,7 @@ const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatId
                     executeNode(curChildIdx[1], qrRight, &curCand, nullptr);
                 } else
                     executeNode(curChildIdx[1], qrRight, nullptr, nullptr);
-                if (qrRight.csrPtr->empty()) {
+                if (!qrRight.hasEpsilon && qrRight.csrPtr->empty()) {
                     qr.assignAsEmpty();
                     if (qrLeft.newed) delete qrLeft.csrPtr;
                     if (qrRight.newed) delete qrRight.csrPtr;
@@ -888,7 +1336,7 @@ const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatId
                     executeNode(curChildIdx[0], qrLeft, nullptr, &curCand, nlcResPtr);
                 } else
                     executeNode(curChildIdx[0], qrLeft, nullptr, nullptr, nlcResPtr);
-                if (qrLeft.csrPtr->empty()) {
+                if (!qrLeft.hasEpsilon && qrLeft.csrPtr->empty()) {
                     qr.assignAsEmpty();
                     if (qrLeft.newed) delete qrLeft.csrPtr;
                     if (qrRight.newed) delete qrRight.csrPtr;
@@ -909,6 +1357,7 @@ const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatId
                 executeNode(curChildIdx[0], qrChild, lCandPtr, rCandPtr, nlcResPtr);
                 if (qrChild.csrPtr->empty()) {
                     qr.assignAsEmpty();
+                    qr.hasEpsilon = curOpType == 2;
                     if (qrChild.newed) delete qrChild.csrPtr;
                     return;
                 }
@@ -918,7 +1367,7 @@ const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatId
                     size_t v = pr.first, vIdx = pr.second;
                     size_t adjStart = qrChild.csrPtr->offset[vIdx], adjEnd = vIdx < qrChild.csrPtr->n - 1 ? qrChild.csrPtr->offset[vIdx + 1] : qrChild.csrPtr->adj.size();
                     for (size_t i = adjStart; i < adjEnd; i++)
-                        vis[0][qrChild.csrPtr->adj[i]] = v;
+                        vis[NUMSTATES - 1][qrChild.csrPtr->adj[i]] = v;
                     copy(qrChild.csrPtr->adj.begin() + adjStart, qrChild.csrPtr->adj.begin() + adjEnd, std::back_inserter(node2Adj[v]));
                     size_t curLen = 0, prevLen = 0;
                     while (true) {
@@ -934,8 +1383,8 @@ const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatId
                                     qrChild.csrPtr->offset[nextNodeIdx + 1] : qrChild.csrPtr->adj.size();
                                 for (size_t j = adjStart2; j < adjEnd2; j++) {
                                     size_t nextNextNode = qrChild.csrPtr->adj[j];
-                                    if (vis[0][nextNextNode] != int(pr.first)) {
-                                        vis[0][nextNextNode] = pr.first;
+                                    if (vis[NUMSTATES - 1][nextNextNode] != int(pr.first)) {
+                                        vis[NUMSTATES - 1][nextNextNode] = pr.first;
                                         node2Adj[v].emplace_back(nextNextNode);
                                     }
                                 }
@@ -952,70 +1401,71 @@ const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatId
                 if (qrChild.newed)
                     delete qrChild.csrPtr;
             } else {
-                // No loop caching
-                // Only pump out the newly produced results to avoid infinite looping
+                // No loop caching, semi-naive: the frontiers of all sources are carried together as one
+                // multi-row delta relation, so the child is evaluated once per closure step (not per source)
                 QueryResult qrFull(nullptr, false);
                 executeNode(curChildIdx[0], qrFull, lCandPtr, rCandPtr, nlcResPtr);
                 if (qrFull.csrPtr->empty()) {
                     qr.assignAsEmpty();
+                    qr.hasEpsilon = curOpType == 2;
                     if (qrFull.newed) delete qrFull.csrPtr;
                     return;
                 }
-                qr.tryNew();
-                QueryResult qrOneNode(nullptr, true);
-                qrOneNode.tryNew();
-                qrOneNode.csrPtr->n = 1;
-                QueryResult qrCur(nullptr, false), qrNext(nullptr, false);
-                qrCur.tryNew();
-                qrCur.csrPtr->n = 1;
-                clearVis(NUMSTATES - 1);
+                // Results and visited sets of each source, indexed by the source's row in qrFull
+                size_t numSrc = qrFull.csrPtr->n;
+                vector<vector<unsigned>> node2Adj(numSrc);
+                vector<unordered_set<unsigned>> visited(numSrc);
+                QueryResult qrDelta(nullptr, false), qrNext(nullptr, false);
+                qrDelta.tryNew();
                 for (const auto &pr : qrFull.csrPtr->v2idx) {
-                    size_t v = pr.first, vIdx = pr.second;
+                    size_t vIdx = pr.second;
                     size_t adjStart = qrFull.csrPtr->offset[vIdx], adjEnd = vIdx < qrFull.csrPtr->n - 1 ? qrFull.csrPtr->offset[vIdx + 1] : qrFull.csrPtr->adj.size();
-                    for (size_t i = adjStart; i < adjEnd; i++)
-                        vis[0][qrFull.csrPtr->adj[i]] = v;
-                    // Re-initialize qrOneNode & qrCur
-                    qrOneNode.csrPtr->v2idx.clear();
-                    qrOneNode.csrPtr->v2idx[v] = 0;
-                    qrOneNode.csrPtr->m = adjEnd - adjStart;
-                    qrOneNode.csrPtr->offset.assign(1, 0);
-                    qrOneNode.csrPtr->adj.clear();
-                    std::move(qrFull.csrPtr->adj.begin() + adjStart, qrFull.csrPtr->adj.begin() + adjEnd, std::back_inserter(qrOneNode.csrPtr->adj));
-                    qrCur.csrPtr->v2idx.clear();
-                    qrCur.csrPtr->v2idx[v] = 0;
-                    qrCur.csrPtr->offset.assign(1, 0);
-                    bool firstIter = true;
-                    while (true) {
-                        // Execute next step; add the new results to qrOneNode; construct as the next seed, swap
-                        if (firstIter) {
-                            executeNode(curChildIdx[0], qrNext, nullptr, nullptr, &qrOneNode);
-                            firstIter = false;
-                        } else
-                            executeNode(curChildIdx[0], qrNext, nullptr, nullptr, &qrCur);
-                        qrCur.csrPtr->adj.clear();
-                        for (unsigned x : qrNext.csrPtr->adj) {
-                            if (vis[0][x] != int(v)) {
-                                vis[0][x] = v;
-                                qrOneNode.csrPtr->adj.emplace_back(x);
-                                qrCur.csrPtr->adj.emplace_back(x);
+                    qrDelta.csrPtr->v2idx[pr.first] = qrDelta.csrPtr->offset.size();
+                    qrDelta.csrPtr->offset.emplace_back(qrDelta.csrPtr->adj.size());
+                    for (size_t i = adjStart; i < adjEnd; i++) {
+                        unsigned x = qrFull.csrPtr->adj[i];
+                        if (visited[vIdx].emplace(x).second) {
+                            node2Adj[vIdx].emplace_back(x);
+                            qrDelta.csrPtr->adj.emplace_back(x);
+                        }
+                    }
+                }
+                qrDelta.csrPtr->n = qrDelta.csrPtr->v2idx.size();
+                qrDelta.csrPtr->m = qrDelta.csrPtr->adj.size();
+                while (!qrDelta.csrPtr->empty()) {
+                    // Join the delta with the child once; keep only the pairs not seen before as the next delta
+                    executeNode(curChildIdx[0], qrNext, nullptr, nullptr, &qrDelta);
+                    qrDelta.clearCsrContent();
+                    for (const auto &pr : qrNext.csrPtr->v2idx) {
+                        size_t vIdx = qrFull.csrPtr->v2idx.find(pr.first)->second; // Delta sources are always qrFull sources
+                        size_t adjStart = qrNext.csrPtr->offset[pr.second], adjEnd = pr.second < qrNext.csrPtr->n - 1 ? qrNext.csrPtr->offset[pr.second + 1] : qrNext.csrPtr->adj.size();
+                        size_t prevSz = qrDelta.csrPtr->adj.size();
+                        for (size_t i = adjStart; i < adjEnd; i++) {
+                            unsigned x = qrNext.csrPtr->adj[i];
+                            if (visited[vIdx].emplace(x).second) {
+                                node2Adj[vIdx].emplace_back(x);
+                                qrDelta.csrPtr->adj.emplace_back(x);
                             }
                         }
-                        if (qrCur.csrPtr->adj.empty())
-                            break;
-                        qrNext.csrPtr->adj.clear();
-                        
+                        if (qrDelta.csrPtr->adj.size() > prevSz) {
+                            qrDelta.csrPtr->v2idx[pr.first] = qrDelta.csrPtr->offset.size();
+                            qrDelta.csrPtr->offset.emplace_back(prevSz);
+                        }
                     }
-                    // Merge qrOneNode into qr
-                    qr.csrPtr->v2idx[v] = qr.csrPtr->offset.size();
+                    qrDelta.csrPtr->n = qrDelta.csrPtr->v2idx.size();
+                    qrDelta.csrPtr->m = qrDelta.csrPtr->adj.size();
+                }
+                qr.tryNew();
+                for (const auto &pr : qrFull.csrPtr->v2idx) {
+                    qr.csrPtr->v2idx[pr.first] = qr.csrPtr->offset.size();
                     qr.csrPtr->offset.emplace_back(qr.csrPtr->adj.size());
-                    move(qrOneNode.csrPtr->adj.begin(), qrOneNode.csrPtr->adj.end(), std::back_inserter(qr.csrPtr->adj));
+                    move(node2Adj[pr.second].begin(), node2Adj[pr.second].end(), std::back_inserter(qr.csrPtr->adj));
                 }
                 qr.csrPtr->n = qr.csrPtr->v2idx.size();
                 qr.csrPtr->m = qr.csrPtr->adj.size();
                 // Delete the new'ed QueryResult
                 if (qrFull.csrPtr && qrFull.newed)  delete qrFull.csrPtr;
-                if (qrOneNode.csrPtr && qrOneNode.newed)  delete qrOneNode.csrPtr;
-                if (qrCur.csrPtr && qrCur.newed)  delete qrCur.csrPtr;
+                if (qrDelta.csrPtr && qrDelta.newed)  delete qrDelta.csrPtr;
                 if (qrNext.csrPtr && qrNext.newed)  delete qrNext.csrPtr;
             }
             if (curOpType == 2)
@@ -1027,9 +1477,96 @@ const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr, int curMatId
     }
 }
 
+/**
+ * @brief Estimate the fraction of the end nodes of endLabelVec that are valid sources of the node
+ * (summed over the end labels). Uses the graph's label-correlation stats when the node is a single
+ * label and stats are filled, and Monte Carlo sampling otherwise.
+ */
+float AndOrDag::estimateMiddleDivIn(const std::vector<LabelOrInverse> &endLabelVec, size_t nodeIdx) {
+    float middleDivIn = 0;
+    if (middleDivInFromStats(endLabelVec, nodeIdx, middleDivIn))
+        return middleDivIn;
+    // Sampled estimates are memoized, so replanning reuses the estimates of plan and of earlier replans
+    string key = estimateKey(endLabelVec, nodeIdx);
+    auto it = estimateCache.find(key);
+    if (it != estimateCache.end()) {
+        estimateCacheHit++;
+        return it->second;
+    }
+    estimateCacheMiss++;
+    middleDivIn = approxMiddleDivInMonteCarlo(endLabelVec, nodeIdx);
+    // If another thread stored the same estimate meanwhile, use the stored one so that all callers agree
+    auto ins = estimateCache.emplace(key, middleDivIn);
+    if (ins.second && nodeIdx >= adHocFromIdx)
+        adHocEstimateKeys.emplace_back(key);    // Ad-hoc nodes are planned serially (see executeAdHoc)
+    return ins.first->second;
+}
+
+// Key of an estimate: the node index and the end labels as a sorted multiset (estimates sum over duplicates)
+std::string AndOrDag::estimateKey(std::vector<LabelOrInverse> endLabelVec, size_t nodeIdx) {
+    sort(endLabelVec.begin(), endLabelVec.end(), [](const LabelOrInverse &a, const LabelOrInverse &b) {
+        return a.lbl < b.lbl || (a.lbl == b.lbl && a.inv < b.inv);
+    });
+    string ret = to_string(nodeIdx);
+    for (const auto &endLabel : endLabelVec)
+        ret += " " + to_string(size_t(endLabel.lbl)) + (endLabel.inv ? "-" : "");
+    return ret;
+}
+
+// Label pair x (end) -> y (next): the fraction of the distinct end nodes of x with y-edges in the required direction,
+// the same vertex fraction approxMiddleDivInMonteCarlo samples
+bool AndOrDag::middleDivInFromStats(const std::vector<LabelOrInverse> &endLabelVec, size_t nodeIdx, float &middleDivIn) const {
+    const Statistics &stats = csrPtr->stats;
+    if (stats.empty() || !nodes[nodeIdx].getChildIdx().empty() || nodes[nodeIdx].getStartLabel().size() != 1)
+        return false;
+    const LabelOrInverse &nextLabel = nodes[nodeIdx].getStartLabel()[0];
+    auto it = csrPtr->label2idx.find(nextLabel.lbl);
+    if (it == csrPtr->label2idx.end())
+        return false;
+    size_t y = it->second;
+    middleDivIn = 0;
+    for (const LabelOrInverse &endLabel : endLabelVec) {
+        it = csrPtr->label2idx.find(endLabel.lbl);
+        if (it == csrPtr->label2idx.end())
+            continue;
+        // End nodes are the targets of x, or its sources if inverse
+        size_t x = it->second;
+        size_t numEnds = endLabel.inv ? csrPtr->outCsr[x].n : csrPtr->inCsr[x].n;
+        if (numEnds == 0)
+            continue;
+        size_t cnt = 0;
+        if (!endLabel.inv && !nextLabel.inv)
+            cnt = stats.tgtOutCnt[x][y];
+        else if (!endLabel.inv && nextLabel.inv)
+            cnt = stats.tgtInCnt[x][y];
+        else if (endLabel.inv && !nextLabel.inv)
+            cnt = stats.srcOutCnt[x][y];
+        else
+            cnt = stats.srcInCnt[x][y];
+        middleDivIn += float(cnt) / float(numEnds);
+    }
+    return true;
+}
+
+// Half width of the 95% confidence interval of a proportion estimated from numSampled of popSz vertices
+// without replacement; smoothed so that estimates at 0 or 1 still need a few samples
+static float sampleCIHalfWidth(size_t numExists, size_t numSampled, size_t popSz) {
+    float p = float(numExists + 1) / float(numSampled + 2);
+    float fpc = float(popSz - numSampled) / float(popSz - 1);
+    return 1.96 * sqrt(p * (1 - p) / float(numSampled) * fpc);
+}
+
+/**
+ * @brief Estimate middleDivIn by probing the end nodes of each end label with the node's DFA.
+ * Labels with at most SAMPLESZ end nodes are probed exhaustively; otherwise samples are drawn
+ * in doubling batches from SAMPLEMIN until the confidence interval is within SAMPLEERR or
+ * SAMPLEMAX samples are probed. Probes run in parallel, each thread with its own visited buffer.
+ */
 float AndOrDag::approxMiddleDivInMonteCarlo(const std::vector<LabelOrInverse> &endLabelVec, size_t nodeIdx) {
     size_t inSz = 0;
     float middleDivIn = 0;
+    vector<size_t> sampleIdx;
+    std::shared_ptr<const NFA> curDfaPtr = nullptr;
     for (const LabelOrInverse &endLabel : endLabelVec) {
         auto it = csrPtr->label2idx.find(endLabel.lbl);
         if (it == csrPtr->label2idx.end())
@@ -1043,45 +1580,51 @@ float AndOrDag::approxMiddleDivInMonteCarlo(const std::vector<LabelOrInverse> &e
         inSz = lblCsrPtr->n;
         if (inSz == 0)
             continue;
-        size_t numExists = 0;
-        unordered_map<unsigned, unsigned>::const_iterator v2idxIt;
-        // cout << endLabel.lbl;
-        // if (endLabel.inv)
-        //     cout << "-";
-        // cout << " " << nodeIdx << endl;
-        std::shared_ptr<NFA> curDfaPtr = nodes[nodeIdx].getDfaPtr();
         if (!curDfaPtr) {
-            Rpq2NFAConvertor cvrt;
-            curDfaPtr = cvrt.convert(idx2q[nodeIdx])->convert2Dfa();
-            assert(curDfaPtr->states.size() < NUMSTATES);   // NUMSTATES - 1 is used for other purposes
+            // Convert once for all end labels. Planning tasks of parents sharing this node run concurrently, so the
+            // cached automaton is not stored back into the node
+            curDfaPtr = nodes[nodeIdx].getDfaPtr();
+            if (!curDfaPtr)
+                curDfaPtr = AutomatonCache::instance().get(idx2q[nodeIdx]);
         }
-        if (!curDfaPtr->vis)
-            curDfaPtr->setVis(this->vis);
-        // curDfaPtr->clearVis(csrPtr->maxNode + 1);    // if remove just for test efficiency, will segfault, need outside new once help
         if (SAMPLESZ >= inSz) {
-            for (const auto &pr : lblCsrPtr->v2idx) {
-                size_t curSrc = pr.first;
-                if (curDfaPtr->checkIfValidSrc(curSrc, csrPtr, curVisMark))
-                    numExists++;
-                curVisMark++;
-            }
-            middleDivIn += float(numExists) / float(inSz);
-        } else {
-            for (size_t i = 0; i < SAMPLESZ; i++) {
-                size_t curIdx = rand() % inSz;  // TODO: no putting back?
-                v2idxIt = lblCsrPtr->v2idx.begin();
-                std::advance(v2idxIt, curIdx);
-                size_t curSrc = v2idxIt->first;
-                if (curDfaPtr->checkIfValidSrc(curSrc, csrPtr, curVisMark))
-                    numExists++;
-                curVisMark++;
-            }
-            middleDivIn += float(numExists) / float(SAMPLESZ);
+            middleDivIn += float(probeSources(*curDfaPtr, *lblCsrPtr, nullptr, 0, inSz)) / float(inSz);
+            continue;
+        }
+        // Random order, so every prefix is a uniform sample without replacement
+        sampleWithoutReplacement(inSz, SAMPLEMAX, sampleIdx);
+        size_t numExists = 0, numSampled = 0, batchEnd = min(size_t(SAMPLEMIN), sampleIdx.size());
+        while (true) {
+            numExists += probeSources(*curDfaPtr, *lblCsrPtr, &sampleIdx, numSampled, batchEnd);
+            numSampled = batchEnd;
+            if (numSampled == sampleIdx.size() || sampleCIHalfWidth(numExists, numSampled, inSz) <= SAMPLEERR)
+                break;
+            batchEnd = min(2 * batchEnd, sampleIdx.size());
         }
+        middleDivIn += float(numExists) / float(numSampled);
     }
     return middleDivIn;
 }
 
+/**
+ * @brief Count the valid sources of the DFA among the vertices of lblCsr at rows (*sampleIdxPtr)[lo, hi)
+ * (rows [lo, hi) if sampleIdxPtr is nullptr), in parallel
+ */
+size_t AndOrDag::probeSources(const NFA &dfa, const MappedCSR &lblCsr, const std::vector<size_t> *sampleIdxPtr,
+size_t lo, size_t hi) {
+    size_t numExists = 0, numStates = dfa.states.size(), gN = csrPtr->maxNode + 1;
+    const MultiLabelCSR &csr = *csrPtr;
+    #pragma omp parallel for schedule(dynamic, 4) reduction(+:numExists) if (!planInParallel && hi - lo > 1)
+    for (size_t i = lo; i < hi; i++) {
+        VisBuffer &visBuf = sampleVis.local();
+        visBuf.reserve(numStates, gN);
+        unsigned curSrc = lblCsr.idx2v[sampleIdxPtr ? (*sampleIdxPtr)[i] : i];
+        if (dfa.checkIfValidSrc(curSrc, csr, visBuf.nextMark(), visBuf.data()))
+            numExists++;
+    }
+    return numExists;
+}
+
 void AndOrDag::materialize() {
     priority_queue<pair<size_t, size_t>, vector<pair<size_t, size_t>>, decltype(&PairSecondLess<size_t, size_t>)> pq(PairSecondLess);
     size_t numNodes = nodes.size();
@@ -1091,13 +1634,379 @@ void AndOrDag::materialize() {
     while (!pq.empty()) {
         size_t curIdx = pq.top().first;
         pq.pop();
+        if (nodes[curIdx].ownsRes() || nodes[curIdx].getReachIdxPtr())
+            continue;   // Already materialized, e.g., adopted from a previous snapshot
         // During the materialization of a node, its own materialized flag should be ignored, but not others'
         // The reverse topological order guarantees correctness
         // cout << idx2q[curIdx] << " ";
         // auto start_time = std::chrono::steady_clock::now();
-        executeNode(curIdx, nodes[curIdx].getRes(), nullptr, nullptr, nullptr, curIdx);
+        vector<LabelOrInverse> lblSet;
+        if (getClosureLabels(curIdx, lblSet) && lcrIdx.find(labelSetKey(lblSet)) != lcrIdx.end()) {
+            // Label-constrained reachability: index the union of the label CSRs directly, once per label set
+            auto &lcrIdxPtr = lcrIdx[labelSetKey(lblSet)];
+            if (!lcrIdxPtr) {
+                vector<const MappedCSR *> rels;
+                for (const auto &lbl : lblSet) {
+                    auto it = csrPtr->label2idx.find(lbl.lbl);
+                    if (it != csrPtr->label2idx.end())
+                        rels.emplace_back(lbl.inv ? &(csrPtr->inCsr[it->second]) : &(csrPtr->outCsr[it->second]));
+                }
+                lcrIdxPtr = make_shared<ReachIndex>();
+                lcrIdxPtr->build(rels);
+            }
+            nodes[curIdx].setReachIdxPtr(lcrIdxPtr);
+        } else if (storeAsReachIdx(curIdx)) {
+            // Index the closure of the child relation instead of storing the pairs
+            size_t childIdx = nodes[nodes[curIdx].getChildIdx()[0]].getChildIdx()[0];
+            QueryResult qrChild(nullptr, false);
+            executeNode(childIdx, qrChild);
+            auto reachIdxPtr = make_shared<ReachIndex>();
+            reachIdxPtr->build(*qrChild.csrPtr);
+            nodes[curIdx].setReachIdxPtr(reachIdxPtr);
+            if (qrChild.newed)
+                delete qrChild.csrPtr;
+        } else {
+            executeNode(curIdx, nodes[curIdx].getRes(), nullptr, nullptr, nullptr, curIdx);
+            nodes[curIdx].shareRes();
+        }
         // auto end_time = std::chrono::steady_clock::now();
         // auto elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
         // std::cout << elapsed_microseconds.count() << " us" << std::endl;
     }
-}
\ No newline at end of file
+}
+
+bool AndOrDag::isKleeneView(size_t idx) const {
+    if (!nodes[idx].getIsEq() || nodes[idx].getChildIdx().size() != 1)
+        return false;
+    char childOpType = nodes[nodes[idx].getChildIdx()[0]].getOpType();
+    return childOpType == 2 || childOpType == 3;
+}
+
+bool AndOrDag::storeAsReachIdx(size_t idx) const {
+    return isLcrView(idx) || (useReachIdx && isKleeneView(idx) && viewSpace(idx) < card[idx]);
+}
+
+size_t AndOrDag::viewSpace(size_t idx) const {
+    bool lcrView = isLcrView(idx);
+    if (lcrView || (useReachIdx && isKleeneView(idx))) {
+        // Index of the child relation: condensation edges in both directions, plus
+        // vertex-to-SCC map, members, offsets and about two landmarks per vertex
+        size_t childIdx = nodes[nodes[idx].getChildIdx()[0]].getChildIdx()[0];
+        size_t idxSpace = 2 * card[childIdx] + 8 * (srcCnt[childIdx] + dstCnt[childIdx]);
+        if (lcrView || idxSpace < card[idx])
+            return idxSpace;
+    }
+    return card[idx];
+}
+
+size_t AndOrDag::getRealUsedSpace() const {
+    size_t ret = 0, numNodes = nodes.size();
+    unordered_set<const ReachIndex *> countedIdx;   // LCR indices are shared by the views over the same label set
+    for (size_t i = 0; i < numNodes; i++) {
+        if (!materialized[i] || nodes[i].getChildIdx().empty())
+            continue;
+        if (nodes[i].getReachIdxPtr()) {
+            if (countedIdx.emplace(nodes[i].getReachIdxPtr().get()).second)
+                ret += nodes[i].getReachIdxPtr()->size();
+        } else if (nodes[i].getRes().csrPtr && nodes[i].ownsRes())
+            ret += nodes[i].getRes().csrPtr->m;
+    }
+    return ret;
+}
+
+/**
+ * @brief Share the materialized views of other (over the same graph) with the nodes of the same queries
+ * chosen here, so that materialize only computes the new views. Views of other not chosen here are dropped
+ * once other is released.
+ *
+ * @return the number of views adopted
+ */
+size_t AndOrDag::adoptViews(const AndOrDag &other) {
+    size_t numAdopted = 0, numNodes = nodes.size();
+    for (size_t i = 0; i < numNodes; i++) {
+        if (!materialized[i] || nodes[i].getChildIdx().empty() || nodes[i].ownsRes() || nodes[i].getReachIdxPtr())
+            continue;
+        auto it = other.q2idx.find(idx2q[i]);
+        if (it == other.q2idx.end() || !other.materialized[it->second])
+            continue;
+        if (!nodes[i].adoptRes(other.nodes[it->second]))
+            continue;
+        numAdopted++;
+        vector<LabelOrInverse> lblSet;
+        if (nodes[i].getReachIdxPtr() && getClosureLabels(i, lblSet)) {
+            auto lcrIt = lcrIdx.find(labelSetKey(lblSet));
+            if (lcrIt != lcrIdx.end() && !lcrIt->second)
+                lcrIt->second = nodes[i].getReachIdxPtr();
+        }
+    }
+    return numAdopted;
+}
+
+// Answer a Kleene view stored as a reachability index, expanding only from the vertices needed
+void AndOrDag::executeReachIdxView(size_t nodeIdx, QueryResult &qr, const std::unordered_set<size_t> *lCandPtr,
+const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr) {
+    const ReachIndex &reachIdx = *nodes[nodeIdx].getReachIdxPtr();
+    bool hasEpsilon = nodes[nodes[nodeIdx].getChildIdx()[0]].getOpType() == 2;
+    if (nlcResPtr) {
+        // Join nlcRes with the closure rows of its end nodes (all rows if nlcRes has epsilon)
+        QueryResult tmpQr(nullptr, false);
+        tmpQr.tryNew();
+        if (nlcResPtr->hasEpsilon)
+            reachIdx.expandAll(*tmpQr.csrPtr);
+        else
+            reachIdx.expand(nlcResPtr->csrPtr->adj, false, *tmpQr.csrPtr);
+        tmpQr.hasEpsilon = hasEpsilon;
+        qr.assignAsJoin(*nlcResPtr, tmpQr);
+        delete tmpQr.csrPtr;
+        return;
+    }
+    qr.tryNew();
+    if (lCandPtr && rCandPtr && lCandPtr->size() * rCandPtr->size() <= REACHPROBEMAX) {
+        // Point lookups
+        for (size_t curSrc : *lCandPtr) {
+            size_t prevSz = qr.csrPtr->adj.size();
+            for (size_t curDst : *rCandPtr)
+                if (reachIdx.reach(curSrc, curDst))
+                    qr.csrPtr->adj.emplace_back(curDst);
+            if (qr.csrPtr->adj.size() > prevSz) {
+                qr.csrPtr->v2idx[curSrc] = qr.csrPtr->offset.size();
+                qr.csrPtr->offset.emplace_back(prevSz);
+            }
+        }
+        qr.csrPtr->n = qr.csrPtr->v2idx.size();
+        qr.csrPtr->m = qr.csrPtr->adj.size();
+    } else if (lCandPtr && (!rCandPtr || lCandPtr->size() <= rCandPtr->size()))
+        reachIdx.expand(vector<unsigned>(lCandPtr->begin(), lCandPtr->end()), false, *qr.csrPtr);
+    else if (rCandPtr)
+        reachIdx.expand(vector<unsigned>(rCandPtr->begin(), rCandPtr->end()), true, *qr.csrPtr);
+    else
+        reachIdx.expandAll(*qr.csrPtr);
+    qr.hasEpsilon = hasEpsilon;
+}
+
+// Collect the labels of a Kleene view whose body is a single label or an alternation of single labels
+bool AndOrDag::getClosureLabels(size_t idx, std::vector<LabelOrInverse> &lblSet) const {
+    if (!isKleeneView(idx))
+        return false;
+    size_t bodyIdx = nodes[nodes[idx].getChildIdx()[0]].getChildIdx()[0];
+    const auto &bodyChildIdx = nodes[bodyIdx].getChildIdx();
+    lblSet.clear();
+    if (bodyChildIdx.empty()) {
+        lblSet = nodes[bodyIdx].getStartLabel();
+        return true;
+    }
+    if (bodyChildIdx.size() != 1 || nodes[bodyChildIdx[0]].getOpType() != 0)
+        return false;
+    for (size_t altChild : nodes[bodyChildIdx[0]].getChildIdx()) {
+        if (!nodes[altChild].getChildIdx().empty())
+            return false;
+        lblSet.insert(lblSet.end(), nodes[altChild].getStartLabel().begin(), nodes[altChild].getStartLabel().end());
+    }
+    return true;
+}
+
+// Canonical key of a label set, in the same syntax as an alternation query, e.g., <1>|<3->
+std::string AndOrDag::labelSetKey(std::vector<LabelOrInverse> lblSet) {
+    sort(lblSet.begin(), lblSet.end(), [](const LabelOrInverse &a, const LabelOrInverse &b) {
+        return a.lbl < b.lbl || (a.lbl == b.lbl && a.inv < b.inv);
+    });
+    string ret;
+    for (size_t i = 0; i < lblSet.size(); i++) {
+        if (i > 0 && lblSet[i].lbl == lblSet[i - 1].lbl && lblSet[i].inv == lblSet[i - 1].inv)
+            continue;
+        if (!ret.empty())
+            ret += "|";
+        ret += "<" + to_string(size_t(lblSet[i].lbl)) + (lblSet[i].inv ? "->" : ">");
+    }
+    return ret;
+}
+
+void AndOrDag::addLcrLabelSet(const std::vector<LabelOrInverse> &lblSet) {
+    if (!lblSet.empty())
+        lcrIdx.emplace(labelSetKey(lblSet), nullptr);
+}
+
+/**
+ * @brief Configure an LCR index for each label set closed over by a frequent Kleene node
+ *
+ * @param minFreq the minimum freq of the Kleene node (call after plan(), which propagates freq)
+ * @return the number of configured label sets
+ */
+size_t AndOrDag::addLcrLabelSetsFromWorkload(size_t minFreq) {
+    size_t numNodes = nodes.size();
+    vector<LabelOrInverse> lblSet;
+    for (size_t i = 0; i < numNodes; i++)
+        if (freq[i] >= minFreq && getClosureLabels(i, lblSet))
+            addLcrLabelSet(lblSet);
+    return lcrIdx.size();
+}
+
+bool AndOrDag::isLcrView(size_t idx) const {
+    if (lcrIdx.empty())
+        return false;
+    vector<LabelOrInverse> lblSet;
+    return getClosureLabels(idx, lblSet) && lcrIdx.find(labelSetKey(lblSet)) != lcrIdx.end();
+}
+
+/**
+ * @brief Group the eq nodes into classes of queries matching the same nonempty paths. A view then also answers
+ * the other non-leaf eq nodes of its class, unless the view matches the empty path and the node does not; the
+ * empty path is added back otherwise (e.g., <1>* from <1>+). Classes come from rewrite rules first: leaves of the
+ * same label, X* and X+ over the same class (also (X+)+, (X*)+ and (X+)*), and X+ with X/X* and its mirror image. The
+ * remaining classes over the same labels are compared by language if their automata have at most MATCHSTATES
+ * states. The nodes before fromIdx keep their classes (only merged), so the dag can be matched again as it grows.
+ *
+ * @return the number of non-leaf eq nodes from fromIdx that share a class with another one
+ */
+size_t AndOrDag::matchViews(size_t fromIdx) {
+    ensureTopoOrder();
+    size_t numNodes = nodes.size();
+    fromIdx = min(fromIdx, equivRoot.size());
+    equivRoot.resize(numNodes);
+    nullable.resize(numNodes);
+    for (size_t i = fromIdx; i < numNodes; i++)
+        equivRoot[i] = i;
+    // Union by the smaller index, so nodes only point to smaller ones and the old nodes never to new ones
+    auto find = [this](size_t x) {
+        while (equivRoot[x] != x) {
+            equivRoot[x] = equivRoot[equivRoot[x]];
+            x = equivRoot[x];
+        }
+        return x;
+    };
+    auto unite = [&](size_t a, size_t b) {
+        a = find(a);
+        b = find(b);
+        if (a != b)
+            equivRoot[max(a, b)] = min(a, b);
+    };
+
+    // Rewrite rules, children before parents
+    unordered_map<string, size_t> ruleKey2idx;
+    vector<size_t> kleeneBody(numNodes, numeric_limits<size_t>::max());  // Class of X for the eq node of X* or X+
+    auto kleeneKey = [&](size_t idx) {
+        return "K" + to_string(kleeneBody[idx] != numeric_limits<size_t>::max() ? find(kleeneBody[idx]) : find(idx));
+    };
+    for (auto it = topoSeq.rbegin(); it != topoSeq.rend(); it++) {
+        size_t idx = *it;
+        const auto &curChildIdx = nodes[idx].getChildIdx();
+        if (!nodes[idx].getIsEq()) {
+            if (idx < fromIdx)
+                continue;
+            char curOpType = nodes[idx].getOpType();
+            if (curOpType == 0)
+                nullable[idx] = any_of(curChildIdx.begin(), curChildIdx.end(), [this](size_t c) { return bool(nullable[c]); });
+            else if (curOpType == 1)
+                nullable[idx] = nullable[curChildIdx[0]] && nullable[curChildIdx[1]];
+            else
+                nullable[idx] = curOpType != 3 || nullable[curChildIdx[0]];
+            continue;
+        }
+        if (curChildIdx.empty()) {
+            const auto &sl = nodes[idx].getStartLabel()[0];
+            unite(ruleKey2idx.emplace("L" + to_string(sl.lbl) + (sl.inv ? "-" : ""), idx).first->second, idx);
+            continue;
+        }
+        if (idx >= fromIdx)
+            nullable[idx] = nullable[curChildIdx[0]];
+        for (size_t opIdx : curChildIdx) {
+            const auto &opChildIdx = nodes[opIdx].getChildIdx();
+            char curOpType = nodes[opIdx].getOpType();
+            if (curOpType == 2 || curOpType == 3) {
+                kleeneBody[idx] = kleeneBody[opChildIdx[0]] != numeric_limits<size_t>::max() ? kleeneBody[opChildIdx[0]] : find(opChildIdx[0]);
+                unite(ruleKey2idx.emplace(kleeneKey(idx), idx).first->second, idx);
+            } else if (curOpType == 1) {
+                // X/X* or X*/X
+                size_t lChild = opChildIdx[0], rChild = opChildIdx[1], xIdx = numeric_limits<size_t>::max();
+                auto isStarOf = [&](size_t starIdx, size_t bodyIdx) {
+                    for (size_t starOpIdx : nodes[starIdx].getChildIdx())
+                        if (nodes[starOpIdx].getOpType() == 2 && find(nodes[starOpIdx].getChildIdx()[0]) == find(bodyIdx))
+                            return true;
+                    return false;
+                };
+                if (isStarOf(rChild, lChild))
+                    xIdx = lChild;
+                else if (isStarOf(lChild, rChild))
+                    xIdx = rChild;
+                if (xIdx != numeric_limits<size_t>::max())
+                    unite(ruleKey2idx.emplace(kleeneKey(xIdx), idx).first->second, idx);
+            }
+        }
+    }
+
+    // Compare the automata of the remaining classes over the same labels, at least one of them with new nodes
+    auto labelSig = [](const string &q) {
+        vector<string> lbls;
+        for (size_t pos = q.find('<'); pos != string::npos; pos = q.find('<', pos + 1))
+            lbls.emplace_back(q.substr(pos, q.find('>', pos) - pos));
+        sort(lbls.begin(), lbls.end());
+        lbls.erase(unique(lbls.begin(), lbls.end()), lbls.end());
+        string ret;
+        for (const auto &lbl : lbls)
+            ret += lbl;
+        return ret;
+    };
+    // The automata are held here for the comparisons only, not stored into the nodes (dfaPtr is for DFAs)
+    unordered_map<size_t, shared_ptr<const NFA>> idx2nfa;
+    auto getDfa = [&](size_t idx) -> const NFA * {
+        auto it = idx2nfa.find(idx);
+        if (it == idx2nfa.end())
+            it = idx2nfa.emplace(idx, AutomatonCache::instance().get(idx2q[idx])).first;
+        const NFA *dfaPtr = it->second.get();
+        return dfaPtr->states.size() <= MATCHSTATES ? dfaPtr : nullptr;
+    };
+    vector<bool> hasNew(numNodes, false);
+    for (size_t i = fromIdx; i < numNodes; i++)
+        if (nodes[i].getIsEq())
+            hasNew[find(i)] = true;
+    unordered_map<string, vector<size_t>> sig2roots;
+    for (size_t i = 0; i < numNodes; i++)
+        if (nodes[i].getIsEq() && find(i) == i && !idx2q[i].empty())
+            sig2roots[labelSig(idx2q[i])].emplace_back(i);
+    for (const auto &pr : sig2roots) {
+        const auto &roots = pr.second;
+        for (size_t j = 1; j < roots.size(); j++) {
+            if (!hasNew[roots[j]])
+                continue;
+            const NFA *dfaJ = getDfa(roots[j]);
+            if (!dfaJ)
+                continue;
+            for (size_t k = 0; k < j; k++) {
+                const NFA *dfaK = find(roots[k]) == roots[k] ? getDfa(roots[k]) : nullptr;
+                if (dfaK && dfaJ->sameNonEmptyLanguage(*dfaK)) {
+                    unite(roots[j], roots[k]);
+                    break;
+                }
+            }
+        }
+    }
+
+    equivNodes.assign(numNodes, {});
+    for (size_t i = 0; i < numNodes; i++) {
+        equivRoot[i] = find(i);
+        if (nodes[i].getIsEq() && !nodes[i].getChildIdx().empty())
+            equivNodes[equivRoot[i]].emplace_back(i);
+    }
+    size_t numMatched = 0;
+    for (auto &members : equivNodes) {
+        if (members.size() == 1)
+            members.clear();
+        for (size_t i : members)
+            if (i >= fromIdx)
+                numMatched++;
+    }
+    return numMatched;
+}
+
+bool AndOrDag::canAnswer(size_t viewIdx, size_t idx) const {
+    return viewIdx != idx && equivRoot[viewIdx] == equivRoot[idx] && (nullable[idx] || !nullable[viewIdx]);
+}
+
+int AndOrDag::answeringView(size_t idx) const {
+    if (idx >= equivRoot.size())
+        return -1;
+    for (size_t viewIdx : equivNodes[equivRoot[idx]])
+        if (materialized[viewIdx] && (nodes[viewIdx].getRes().csrPtr || nodes[viewIdx].getReachIdxPtr()) && canAnswer(viewIdx, idx))
+            return viewIdx;
+    return -1;
+}
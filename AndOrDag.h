@@ -1,8 +1,22 @@
 #pragma once
 #include "CSR.h"
 #include "Rpq2NFAConvertor.h"
-#define SAMPLESZ 100
+#include "ReachIndex.h"
+#include "RpqAst.h"
+#include "AutomatonCache.h"
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/concurrent_unordered_map.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <mutex>
+#define SAMPLESZ 100    // Labels with at most SAMPLESZ end nodes are probed exhaustively
+#define SAMPLEMIN 32    // First batch of adaptive sampling
+#define SAMPLEMAX 1000  // Max #samples per estimate
+#define SAMPLEERR 0.05  // Stop sampling once the 95% confidence interval half width is within SAMPLEERR
 #define NUMSTATES 20
+#define REPLANBATCH 32   // Max #stale candidates replanned together in a round of greedy view selection
+#define REACHPROBEMAX 65536 // Max #(source, target) candidate pairs answered by point lookups on a reachability index
+#define MATCHSTATES 32  // Max #automaton states of a query compared by language in view matching
 
 struct LabelOrInverse {
     double lbl;
@@ -21,12 +35,18 @@ class AndOrDagNode {
     bool left2right;    // For concat op nodes, whether execute from left to right; for Kleene op nodes, whether fix-point (true) or no loop caching (false)
     std::shared_ptr<NFA> dfaPtr;    // DFA for equivalence nodes
     QueryResult res;  // Result pointer for materialized nodes
+    std::shared_ptr<ReachIndex> reachIdxPtr;    // For materialized Kleene nodes stored as a reachability index instead of res
+    std::shared_ptr<MappedCSR> resOwner;    // Owns res.csrPtr once shared, so that snapshots of the dag can share materialized views
 public:
-    AndOrDagNode(): isEq(true), opType(0), topoOrder(-1), targetChild(0), left2right(true), dfaPtr(nullptr), res(nullptr, false) {}
-    AndOrDagNode(bool isEq_, char opType_): isEq(isEq_), opType(opType_), topoOrder(-1), targetChild(0), left2right(true), dfaPtr(nullptr), res(nullptr, false) {}
+    AndOrDagNode(): isEq(true), opType(0), topoOrder(-1), targetChild(0), left2right(true), dfaPtr(nullptr), res(nullptr, false), reachIdxPtr(nullptr) {}
+    AndOrDagNode(bool isEq_, char opType_): isEq(isEq_), opType(opType_), topoOrder(-1), targetChild(0), left2right(true), dfaPtr(nullptr), res(nullptr, false), reachIdxPtr(nullptr) {}
     ~AndOrDagNode() { if (res.newed) delete res.csrPtr; }
     void addChild(size_t c) { childIdx.emplace_back(c); }
     void addParent(size_t c) { parentIdx.emplace_back(c); }
+    // Drop the parents with indices >= numNodes (removed from the dag)
+    void removeParentsFrom(size_t numNodes) {
+        parentIdx.erase(std::remove_if(parentIdx.begin(), parentIdx.end(), [numNodes](size_t p) { return p >= numNodes; }), parentIdx.end());
+    }
     void setIsEq(bool isEq_) { isEq = isEq_; }
     void setOpType(char opType_) { opType = opType_; }
     bool getIsEq() const { return isEq; }
@@ -46,8 +66,59 @@ public:
     void setLeft2Right(bool left2right_) { left2right = left2right_; }
     bool getLeft2Right() const { return left2right; }
     std::shared_ptr<NFA> getDfaPtr() const { return dfaPtr; }
+    void setDfaPtr(std::shared_ptr<NFA> dfaPtr_) { dfaPtr = dfaPtr_; }
     QueryResult &getRes() { return res; }
     const QueryResult &getRes() const { return res; }
+    std::shared_ptr<ReachIndex> getReachIdxPtr() const { return reachIdxPtr; }
+    void setReachIdxPtr(std::shared_ptr<ReachIndex> reachIdxPtr_) { reachIdxPtr = reachIdxPtr_; }
+    bool ownsRes() const { return res.newed || resOwner; }
+    // Hand the ownership of a newed res over to resOwner
+    void shareRes() {
+        if (res.newed) {
+            resOwner.reset(res.csrPtr);
+            res.newed = false;
+        }
+    }
+    // Use the materialized view of another node (of another dag) over the same query; false if it cannot be shared
+    bool adoptRes(const AndOrDagNode &other) {
+        if (other.res.newed || (!other.resOwner && !other.reachIdxPtr))
+            return false;
+        res = other.res;
+        resOwner = other.resOwner;
+        reachIdxPtr = other.reachIdxPtr;
+        return true;
+    }
+};
+
+// Outcome of replanning with a set of views materialized, applied to the dag by applyChanges
+struct ReplanResult {
+    std::vector<std::pair<size_t, float>> node2cost;    // New cost of each node whose cost decreases, children before parents
+    std::vector<std::pair<size_t, bool>> left2right;    // Execution modes of Kleene op nodes under the new costs
+    std::vector<std::pair<size_t, size_t>> targetChild; // Eq nodes whose cheapest concat child changes
+    float reducedCost;
+    ReplanResult(): reducedCost(0) {}
+};
+
+// Scratch arrays of replan. An entry is valid only if its stamp equals the current epoch, so that a replan
+// starts in O(1) instead of clearing; each thread owns one to evaluate candidate views concurrently
+struct ReplanWorkspace {
+    std::vector<float> newCost; // Tentative cost
+    std::vector<float> pending; // Eq nodes: min cost offered by children; alternation/? nodes: sum of children's cost decrease
+    std::vector<size_t> pendingChild;   // Eq nodes: the concat child offering the min cost (or the node itself)
+    std::vector<size_t> costStamp, queuedStamp;
+    std::priority_queue<int> worklist;  // Topological orders of the queued nodes, deepest first
+    size_t epoch;
+    ReplanWorkspace(): epoch(0) {}
+    void reset(size_t numNodes) {
+        if (costStamp.size() != numNodes) {
+            newCost.assign(numNodes, 0);
+            pending.assign(numNodes, 0);
+            pendingChild.assign(numNodes, 0);
+            costStamp.assign(numNodes, 0);
+            queuedStamp.assign(numNodes, 0);
+        }
+        epoch++;
+    }
 };
 
 class AndOrDag {
@@ -57,6 +128,13 @@ class AndOrDag {
     std::vector<bool> materialized;
     std::vector<float> cost;
     std::vector<size_t> workloadFreq;
+    std::vector<size_t> topoSeq;    // Node indices by topological order (roots first), filled by topoSort
+    bool auxInit, planned;  // Whether initAuxiliary / plan have been called; later queries then grow the dag live
+    bool normalizeQueries;  // Whether queries are keyed by their normalized text (see RpqAst::normalize)
+    // Hash-consing of sub-expressions, so that a query is parsed once: (operator, operand expression ids) -> expression
+    // id, where an operand is an AST node or a range of a concatenation; and the eq node of each expression id (or -1)
+    std::unordered_map<std::vector<size_t>, size_t, IdSeqHash> exprIds;
+    std::vector<int> expr2idx;
 
     // Cardinality stuff
     std::vector<size_t> srcCnt, dstCnt;
@@ -67,14 +145,52 @@ class AndOrDag {
     std::shared_ptr<MultiLabelCSR> csrPtr;
 
     int **vis;
-    int curVisMark;
+    tbb::enumerable_thread_specific<VisBuffer> sampleVis;   // Per-thread visited buffers of sampling probes
+
+    tbb::concurrent_unordered_map<std::string, float> estimateCache;    // Memoized sampled middleDivIn, keyed by estimateKey
+    std::atomic<size_t> estimateCacheHit, estimateCacheMiss;
+    size_t adHocFromIdx;    // The nodes from this index on are ad hoc (see executeAdHoc); max() if none
+    std::vector<std::string> adHocEstimateKeys; // Keys of the estimates cached for ad-hoc nodes, erased with them
+    tbb::enumerable_thread_specific<ReplanWorkspace> replanWs;
+    size_t replanBatch; // #stale candidates replanned in parallel per round of greedy selection (1: one at a time)
+    bool planInParallel;    // Set while plan() runs tasks in parallel, so that sampling does not nest parallel loops
+
+    bool useReachIdx;   // Whether Kleene views may be stored as reachability indices when smaller than their pairs
+    // Label-constrained reachability indices, keyed by label set (nullptr until materialized); shared by all views over the set
+    std::unordered_map<std::string, std::shared_ptr<ReachIndex>> lcrIdx;
+
+    bool useViewMatch;  // Whether views may answer the eq nodes of equivalent queries (see matchViews)
+    std::vector<size_t> equivRoot;  // Smallest node index in the node's class of queries with the same nonempty paths
+    std::vector<std::vector<size_t>> equivNodes;    // Non-leaf eq nodes of each class with more than one, indexed by root
+    std::vector<bool> nullable; // Whether the node's query matches the empty path
+
+    bool getClosureLabels(size_t idx, std::vector<LabelOrInverse> &lblSet) const;
+    static std::string labelSetKey(std::vector<LabelOrInverse> lblSet);
+    void ensureTopoOrder(); // topoSort if nodes were added since the last sort
+    size_t internExpr(const std::vector<size_t> &key);
+    size_t addAstNode(RpqAst &ast, size_t astIdx, const std::vector<size_t> &astExpr);
+    size_t addConcat(RpqAst &ast, const size_t *eltIdx, size_t from, size_t to, const std::vector<size_t> &astExpr);
+    size_t addEqNode(size_t exprId, const std::string &text, bool &found);
+    void fillLeafQueries(size_t fromIdx);   // Set idx2q of the leaves from fromIdx not in q2idx
+    void growAuxiliary(size_t oldNumNodes); // Extend the auxiliary arrays and the topological order to the nodes added since
+    void annotateLeaf(size_t idx);
+    void removeNodesFrom(size_t numNodes);    // Remove the nodes added after the dag had numNodes nodes
+    static std::string estimateKey(std::vector<LabelOrInverse> endLabelVec, size_t nodeIdx);
+    bool canAnswer(size_t viewIdx, size_t idx) const;   // Whether a view at viewIdx could answer the eq node idx
+
+    void executeReachIdxView(size_t nodeIdx, QueryResult &qr, const std::unordered_set<size_t> *lCandPtr,
+        const std::unordered_set<size_t> *rCandPtr, QueryResult *nlcResPtr);
 
 public:
-    AndOrDag(): csrPtr(nullptr), vis(nullptr), curVisMark(INT_MIN) {}
-    AndOrDag(std::shared_ptr<MultiLabelCSR> csrPtr_): csrPtr(csrPtr_), vis(nullptr), curVisMark(INT_MIN) { clearVis(); }
+    AndOrDag(): auxInit(false), planned(false), normalizeQueries(false), csrPtr(nullptr), vis(nullptr), estimateCacheHit(0), estimateCacheMiss(0), adHocFromIdx(std::numeric_limits<size_t>::max()), replanBatch(REPLANBATCH), planInParallel(false), useReachIdx(false), useViewMatch(false) {}
+    AndOrDag(std::shared_ptr<MultiLabelCSR> csrPtr_): auxInit(false), planned(false), normalizeQueries(false), csrPtr(csrPtr_), vis(nullptr), estimateCacheHit(0),
+    estimateCacheMiss(0), adHocFromIdx(std::numeric_limits<size_t>::max()), replanBatch(REPLANBATCH), planInParallel(false), useReachIdx(false), useViewMatch(false) { clearVis(); }
     AndOrDag(const AndOrDag &aod_): nodes(aod_.nodes), q2idx(aod_.q2idx), idx2q(aod_.idx2q), materialized(aod_.materialized),
-    cost(aod_.cost), workloadFreq(aod_.workloadFreq), srcCnt(aod_.srcCnt), dstCnt(aod_.dstCnt), card(aod_.card), freq(aod_.freq),
-    useCnt(aod_.useCnt), csrPtr(aod_.csrPtr), vis(nullptr), curVisMark(INT_MIN) {
+    cost(aod_.cost), workloadFreq(aod_.workloadFreq), topoSeq(aod_.topoSeq), auxInit(aod_.auxInit),
+    planned(aod_.planned), normalizeQueries(aod_.normalizeQueries), exprIds(aod_.exprIds), expr2idx(aod_.expr2idx), srcCnt(aod_.srcCnt), dstCnt(aod_.dstCnt), card(aod_.card), freq(aod_.freq),
+    useCnt(aod_.useCnt), csrPtr(aod_.csrPtr), vis(nullptr), estimateCache(aod_.estimateCache), estimateCacheHit(0),
+    estimateCacheMiss(0), adHocFromIdx(std::numeric_limits<size_t>::max()), replanBatch(aod_.replanBatch), planInParallel(false), useReachIdx(aod_.useReachIdx), lcrIdx(aod_.lcrIdx),
+    useViewMatch(aod_.useViewMatch), equivRoot(aod_.equivRoot), equivNodes(aod_.equivNodes), nullable(aod_.nullable) {
         // Copy constructor avoid vis double delete
         clearVis();
     }
@@ -102,8 +218,10 @@ public:
                 memset(vis[idx], -1, gN * sizeof(int));
         }
     }
-    void addWorkloadQuery(const std::string &q, size_t curFreq);   // Add the query q to the dag and mark as workload query
-    int addQuery(const std::string &q);   // Add the query q to the dag
+    int addWorkloadQuery(const std::string &q, size_t curFreq);   // Add the query q to the dag (planned if the dag is) and mark as workload query
+    int addQuery(const std::string &q);   // Add the query q to the dag (as is; addWorkloadQuery normalizes if set)
+    std::string queryKey(const std::string &q) const { return normalizeQueries ? RpqAst::normalize(q) : q; }
+    void setNormalizeQueries(bool normalizeQueries_) { normalizeQueries = normalizeQueries_; }
     void initAuxiliary();   // Call after finished constructing the dag
     void annotateLeafCostCard(); // Annotate leaf nodes' srcCnt, dstCnt, pairProb, cost
     float chooseMatViews(char mode, size_t &usedSpace, size_t spaceBudget=std::numeric_limits<size_t>::max(), std::string *testOut=nullptr);
@@ -111,12 +229,33 @@ public:
     void propagate();
     void propagateFreq(size_t idx, size_t propVal); // Propagate freq from the current node
     void propagateUseCnt(size_t idx, int delta);    // Propagate useCnt change from the current node
-    void replanWithMaterialize(const std::vector<size_t> &matIdx, std::unordered_map<size_t, float> &node2cost, float &reducedCost); // Replan the dag assuming the input views are materialized
-    void applyChanges(const std::vector<size_t> &matIdx, const std::unordered_map<size_t, float> &node2cost, bool updateUseCnt=false);    // Apply the changes from replan to the dag
-    void updateNodeCost(size_t nodeIdx, std::unordered_map<size_t, float> &node2cost, float &reducedCost, float updateCost=-1); // Update the cost of a node (and its ancestors); -1 means update to cardinality
-    void planNode(size_t nodeIdx);
+    void propagateFreq(const std::vector<std::pair<size_t, size_t>> &idx2propVal); // Batched, one topological pass
+    void propagateUseCnt(const std::vector<std::pair<size_t, int>> &idx2delta);    // Batched, one topological pass
+    void replan(const std::vector<size_t> &matIdx, ReplanWorkspace &ws, ReplanResult &res);  // Replan the dag assuming the input (eq node) views are materialized, without changing it
+    void replanCandidates(const std::vector<size_t> &candIdx, std::vector<ReplanResult> &results);  // Replan with each candidate view materialized alone, in parallel
+    void applyChanges(const std::vector<size_t> &matIdx, const ReplanResult &res, bool updateUseCnt=false);    // Apply the changes from replan to the dag
+    void planNode(size_t nodeIdx);  // Plan the node and (recursively) its unplanned descendants
+    void planNodeFromChildren(size_t nodeIdx);  // Plan the node only; its children must be planned
     void materialize(); // Materialize the chosen views
+    bool isKleeneView(size_t idx) const;    // Whether the node is an equivalence node of a Kleene closure
+    bool storeAsReachIdx(size_t idx) const; // Whether the view of the node is stored as a reachability index
+    size_t viewSpace(size_t idx) const; // Estimated space of materializing the node, in #node pairs
+    size_t getRealUsedSpace() const;    // Actual space of the materialized views, in #node pairs
+    size_t adoptViews(const AndOrDag &other);   // Share the views of other that are also chosen here, so materialize skips them
+    size_t matchViews(size_t fromIdx=0);    // Find the eq nodes of equivalent queries (from fromIdx), so views answer them too
+    int answeringView(size_t idx) const;    // A materialized view answering the eq node idx in its place, or -1
+    void setUseViewMatch(bool useViewMatch_) { useViewMatch = useViewMatch_; }
+    void setUseReachIdx(bool useReachIdx_) { useReachIdx = useReachIdx_; }
+    void setReplanBatch(size_t replanBatch_) { replanBatch = replanBatch_ > 0 ? replanBatch_ : 1; }
+    size_t getEstimateCacheHit() const { return estimateCacheHit; }
+    size_t getEstimateCacheMiss() const { return estimateCacheMiss; }
+    const tbb::concurrent_unordered_map<std::string, float> &getEstimateCache() const { return estimateCache; }
+    void clearEstimateCache() { estimateCache.clear(); estimateCacheHit = 0; estimateCacheMiss = 0; }
+    void addLcrLabelSet(const std::vector<LabelOrInverse> &lblSet);  // Allow views (l_1|l_2|...)* and + over the label set to be LCR lookups
+    size_t addLcrLabelSetsFromWorkload(size_t minFreq=1);   // Add the label sets closed over by nodes with freq >= minFreq
+    bool isLcrView(size_t idx) const;   // Whether the node is a Kleene closure over a configured label set
     void execute(const std::string &q, QueryResult &qr); // Execute a query with the dag
+    void executeAdHoc(const std::string &q, QueryResult &qr);   // Execute a query not necessarily in the dag, on top of its views
     // Execute a node with the dag
     void executeNode(size_t nodeIdx, QueryResult &qr, const std::unordered_set<size_t> *lCandPtr=nullptr,
         const std::unordered_set<size_t> *rCandPtr=nullptr, QueryResult *nlcResPtr=nullptr, int curMatIdx=-1);
@@ -131,7 +270,7 @@ public:
     }
     void setAsWorkloadQuery(const std::string &q, size_t useCnt_, int workloadFreq_=-1) {
         // For testing only
-        auto it = q2idx.find(q);
+        auto it = q2idx.find(queryKey(q));
         if (it == q2idx.end())
             return;
         freq[it->second] = useCnt_;
@@ -150,6 +289,7 @@ public:
     const std::vector<size_t> &getDstCnt() const { return dstCnt; }
     const std::vector<size_t> &getCard() const { return card; }
     const std::vector<float> &getCost() const { return cost; }
+    const std::vector<size_t> &getEquivRoot() const { return equivRoot; }
     std::vector<size_t> &getWorkloadFreq() { return workloadFreq; }
     std::vector<size_t> &getFreq() { return freq; }
     std::vector<int> &getUseCnt() { return useCnt; }
@@ -158,7 +298,7 @@ public:
     void setDstCnt(size_t idx, size_t dstCnt_) { dstCnt[idx] = dstCnt_; }
     void setCost(size_t idx, float cost_) { cost[idx] = cost_; }
     void setCard(size_t idx, size_t card_) { card[idx] = card_; }
-    void setCsrPtr(std::shared_ptr<MultiLabelCSR> &csrPtr_) { csrPtr = csrPtr_; clearVis(); }
+    void setCsrPtr(std::shared_ptr<MultiLabelCSR> &csrPtr_) { csrPtr = csrPtr_; clearVis(); clearEstimateCache(); }
     void addParentChild(size_t p, size_t c) {
         nodes[p].addChild(c);
         nodes[c].addParent(p);
@@ -174,4 +314,7 @@ public:
             materialized[idx] = true;
     }
     float approxMiddleDivInMonteCarlo(const std::vector<LabelOrInverse> &endLabelVec, size_t nodeIdx);
+    size_t probeSources(const NFA &dfa, const MappedCSR &lblCsr, const std::vector<size_t> *sampleIdxPtr, size_t lo, size_t hi);
+    float estimateMiddleDivIn(const std::vector<LabelOrInverse> &endLabelVec, size_t nodeIdx); // Stats if applicable, else Monte Carlo
+    bool middleDivInFromStats(const std::vector<LabelOrInverse> &endLabelVec, size_t nodeIdx, float &middleDivIn) const;
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "AndOrDag.h"
+#include "OnlineViewManager.h"
 using namespace std;
 
 // AND-OR DAG file format: (expected output of CustomTest, input of buildAndOrDagFromFile)
@@ -230,6 +231,10 @@ TEST(AddQueryTestSuite, OverlapTest) {
     CustomTest("OverlapTest");
 }
 
+TEST(AddQueryTestSuite, SharedSubqueryTest) {
+    CustomTest("SharedSubqueryTest");
+}
+
 TEST(UseCntTestSuite, TwoRootsTest) {
     string dataDir = "../test_data/UseCntTestSuite/", testName = "TwoRootsTest";
     std::string inputFileName = dataDir + testName + "_input.txt";
@@ -315,6 +320,52 @@ TEST(UseCntTestSuite, SingleRootTest) {
     useCntTest("SingleRootTest");
 }
 
+TEST(UseCntTestSuite, SharedSubqueryTest) {
+    // Long concatenations share their sub-concatenations along many paths; propagate visits each node once
+    // but must still count every path, as the per-path recursion does
+    AndOrDag aod;
+    aod.addWorkloadQuery("<1>/<2>/<3>/<4>/<5>/<6>/<7>/<8>", 3);
+    aod.addWorkloadQuery("<2>/<3>/<4>/<5>/<6>/<7>", 2);
+    aod.addWorkloadQuery("(<3>/<4>/<5>)*", 1);
+    size_t numNodes = aod.getNumNodes();
+    aod.getMaterialized().assign(numNodes, false);
+    for (size_t i = 0; i < numNodes; i++)
+        if (aod.getNodes()[i].getIsEq() && aod.getNodes()[i].getChildIdx().size() > 1)
+            aod.getNodes()[i].setTargetChild(aod.getNodes()[i].getChildIdx().back());
+    aod.getMaterialized()[aod.getQ2idx().at("<3>/<4>/<5>")] = true;
+    vector<size_t> expectedFreq(aod.getFreq());
+    aod.propagate();
+
+    vector<int> expectedUseCnt(numNodes, 0);
+    std::function<void(size_t, size_t)> addFreq = [&](size_t idx, size_t val) {
+        for (size_t childIdx : aod.getNodes()[idx].getChildIdx()) {
+            expectedFreq[childIdx] += val;
+            addFreq(childIdx, val);
+        }
+    };
+    std::function<void(size_t)> addUseCnt = [&](size_t idx) {
+        expectedUseCnt[idx]++;
+        if (aod.getMaterialized()[idx])
+            return;
+        const auto &node = aod.getNodes()[idx];
+        if (node.getIsEq() && node.getChildIdx().size() > 1)
+            addUseCnt(node.getTargetChild());
+        else
+            for (size_t childIdx : node.getChildIdx())
+                addUseCnt(childIdx);
+    };
+    for (size_t i = 0; i < numNodes; i++) {
+        if (aod.getNodes()[i].getParentIdx().empty())
+            addFreq(i, expectedFreq[i]);
+        if (aod.getWorkloadFreq()[i] > 0)
+            addUseCnt(i);
+    }
+    for (size_t i = 0; i < numNodes; i++) {
+        EXPECT_EQ(aod.getFreq()[i], expectedFreq[i]);
+        EXPECT_EQ(aod.getUseCnt()[i], expectedUseCnt[i]);
+    }
+}
+
 TEST(AnnotateLeafCostCardTestSuite, SimpleTest) {
     // Construct outCsr, inCsr for 0-[0]->1-[1]->2-[2]->3-[3]->4
     auto csrPtr = make_shared<MultiLabelCSR>();
@@ -406,6 +457,93 @@ TEST(PlanTestSuite, KleeneIriConcatTest) {
     }
 }
 
+TEST(PlanTestSuite, LevelParallelTest) {
+    // Small labels are probed exhaustively, so the level-parallel plan equals the recursive one
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    vector<string> qVec({"<1>/<2>/<3>", "(<1>/<2>)+/<3>", "(<1>|<2>)*/<3>", "<2>/<3>/<3->", "((<1>/<2>)*|<3>)/<3>"});
+    AndOrDag aod(csrPtr), aodSerial(csrPtr);
+    for (AndOrDag *aodPtr : {&aod, &aodSerial}) {
+        for (const auto &q : qVec)
+            aodPtr->addWorkloadQuery(q, 1);
+        aodPtr->initAuxiliary();
+        aodPtr->annotateLeafCostCard();
+    }
+    aod.plan();
+    for (size_t i = 0; i < aodSerial.getNumNodes(); i++)
+        if (aodSerial.getFreq()[i] > 0)
+            aodSerial.planNode(i);
+    aodSerial.propagate();
+    for (size_t i = 0; i < aod.getNumNodes(); i++) {
+        EXPECT_FLOAT_EQ(aod.getCost()[i], aodSerial.getCost()[i]);
+        EXPECT_EQ(aod.getCard()[i], aodSerial.getCard()[i]);
+        EXPECT_EQ(aod.getSrcCnt()[i], aodSerial.getSrcCnt()[i]);
+        EXPECT_EQ(aod.getDstCnt()[i], aodSerial.getDstCnt()[i]);
+        EXPECT_EQ(aod.isMaterialized(i), aodSerial.isMaterialized(i));
+        EXPECT_EQ(aod.getNodes()[i].getLeft2Right(), aodSerial.getNodes()[i].getLeft2Right());
+        if (aod.getNodes()[i].getIsEq() && aod.getNodes()[i].getChildIdx().size() > 1) {
+            EXPECT_EQ(aod.getNodes()[i].getTargetChild(), aodSerial.getNodes()[i].getTargetChild());
+        }
+        EXPECT_EQ(aod.getFreq()[i], aodSerial.getFreq()[i]);
+        EXPECT_EQ(aod.getUseCnt()[i], aodSerial.getUseCnt()[i]);
+    }
+}
+
+TEST(PlanTestSuite, IncrementalAddTest) {
+    // Queries added to a planned dag are planned on the spot, as if they had been in the workload from the start
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    vector<string> qVec1({"<1>/<2>/<3>", "(<1>|<2>)*/<3>"}), qVec2({"<2>/<3>/<3->", "((<1>/<2>)*|<3->)/<3>"});
+    AndOrDag aod(csrPtr), aodFull(csrPtr);
+    for (const auto &q : qVec1) {
+        aod.addWorkloadQuery(q, 2);
+        aodFull.addWorkloadQuery(q, 2);
+    }
+    for (const auto &q : qVec2)
+        aodFull.addWorkloadQuery(q, 1);
+    for (AndOrDag *aodPtr : {&aod, &aodFull}) {
+        aodPtr->initAuxiliary();
+        aodPtr->annotateLeafCostCard();
+        aodPtr->plan();
+    }
+    for (const auto &q : qVec2) {
+        int idx = aod.addWorkloadQuery(q, 1);
+        ASSERT_EQ(idx, aod.getQ2idx().at(q));
+    }
+    ASSERT_EQ(aod.getNumNodes(), aodFull.getNumNodes());
+    for (size_t i = 0; i < aod.getNumNodes(); i++)
+        for (size_t childIdx : aod.getNodes()[i].getChildIdx())
+            EXPECT_LT(aod.getNodes()[i].getTopoOrder(), aod.getNodes()[childIdx].getTopoOrder());
+    for (const auto &pr : aodFull.getQ2idx()) {
+        size_t idx = aod.getQ2idx().at(pr.first), fullIdx = pr.second;
+        EXPECT_FLOAT_EQ(aod.getCost()[idx], aodFull.getCost()[fullIdx]);
+        EXPECT_EQ(aod.getCard()[idx], aodFull.getCard()[fullIdx]);
+        EXPECT_EQ(aod.isMaterialized(idx), aodFull.isMaterialized(fullIdx));
+        EXPECT_EQ(aod.getFreq()[idx], aodFull.getFreq()[fullIdx]);
+        EXPECT_EQ(aod.getUseCnt()[idx], aodFull.getUseCnt()[fullIdx]);
+    }
+
+    // With views materialized, a new query is answered on top of them
+    size_t usedSpace = 0;
+    aod.chooseMatViews(0, usedSpace);
+    aod.materialize();
+    const string q = "(<1>|<2>)*/<3>/<3->";
+    aod.addWorkloadQuery(q, 1);
+    aodFull.addWorkloadQuery(q, 1);
+    QueryResult qr(nullptr, false), qrFull(nullptr, false);
+    aod.execute(q, qr);
+    aodFull.execute(q, qrFull);
+    ASSERT_NE(qr.csrPtr, nullptr);
+    ASSERT_NE(qrFull.csrPtr, nullptr);
+    EXPECT_EQ(qr.csrPtr->m, qrFull.csrPtr->m);
+    EXPECT_EQ(qr.csrPtr->n, qrFull.csrPtr->n);
+    EXPECT_LE(aod.getCost()[aod.getQ2idx().at(q)], aodFull.getCost()[aodFull.getQ2idx().at(q)]);
+    if (qr.newed)
+        delete qr.csrPtr;
+    if (qrFull.newed)
+        delete qrFull.csrPtr;
+}
+
 TEST(TopoSortTestSuite, KleeneIriConcatTest) {
     string dataDir = "../test_data/TopoSortTestSuite/";
     AndOrDag aod;
@@ -423,13 +561,8 @@ TEST(TopoSortTestSuite, KleeneIriConcatTest) {
     }
 }
 
-TEST(ReplanWithMaterializeTestSuite, KleeneIriConcatTest) {
-    string dataDir = "../test_data/ReplanWithMaterializeTestSuite/";
-    string graphFilePath = dataDir + "KleeneIriConcatTest_graph.txt";
-    auto csrPtr = make_shared<MultiLabelCSR>();
-    csrPtr->loadGraph(graphFilePath);
-
-    AndOrDag aod(csrPtr);
+// Build the dag of ReplanWithMaterializeTestSuite's KleeneIriConcatTest with its plan (from the cost file) and workload
+void buildReplanTestDag(AndOrDag &aod, const string &dataDir) {
     string inputFileName = dataDir + "KleeneIriConcatTest_input.txt";
     buildAndOrDagFromFile(aod, inputFileName);
     aod.initAuxiliary();
@@ -457,20 +590,30 @@ TEST(ReplanWithMaterializeTestSuite, KleeneIriConcatTest) {
     while (queryFile >> q)
         aod.setAsWorkloadQuery(q, 1);
     queryFile.close();
+}
 
+TEST(ReplanWithMaterializeTestSuite, KleeneIriConcatTest) {
+    string dataDir = "../test_data/ReplanWithMaterializeTestSuite/";
+    string graphFilePath = dataDir + "KleeneIriConcatTest_graph.txt";
+    auto csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph(graphFilePath);
+
+    AndOrDag aod(csrPtr);
+    buildReplanTestDag(aod, dataDir);
     string matFileName = dataDir + "KleeneIriConcatTest_mat.txt";
     std::ifstream matFile(matFileName);
     ASSERT_EQ(matFile.is_open(), true);
     std::vector<size_t> matIdx;
-    std::unordered_map<size_t, float> node2cost;
-    float reducedCost = 0;
+    string q;
     while (matFile >> q) {
         auto it = aod.getQ2idx().find(q);
         ASSERT_EQ(it != aod.getQ2idx().end(), true);
         matIdx.emplace_back(it->second);
     }
-    vector<size_t> vIdxAdded, vIdxRemoved;
-    aod.replanWithMaterialize(matIdx, node2cost, reducedCost);
+    ReplanWorkspace ws;
+    ReplanResult res;
+    aod.replan(matIdx, ws, res);
+    std::unordered_map<size_t, float> node2cost(res.node2cost.begin(), res.node2cost.end());
 
     // Compare the actual result with the expected result
     // File format: len(node2cost)
@@ -480,6 +623,7 @@ TEST(ReplanWithMaterializeTestSuite, KleeneIriConcatTest) {
     std::ifstream expectedOutputFile(expectedOutputFileName);
     ASSERT_EQ(expectedOutputFile.is_open(), true);
     size_t numNode2cost = 0, curNodeIdx = 0;
+    float curCost = 0;
     expectedOutputFile >> numNode2cost;
     ASSERT_EQ(node2cost.size(), numNode2cost);
     for (size_t i = 0; i < numNode2cost; i++) {
@@ -489,10 +633,84 @@ TEST(ReplanWithMaterializeTestSuite, KleeneIriConcatTest) {
         EXPECT_FLOAT_EQ(it->second, curCost);
     }
     expectedOutputFile >> curCost;
-    EXPECT_FLOAT_EQ(reducedCost, curCost);
+    EXPECT_FLOAT_EQ(res.reducedCost, curCost);
     expectedOutputFile.close();
 }
 
+TEST(ReplanWithMaterializeTestSuite, ConcurrentCandidatesTest) {
+    // Candidates replanned concurrently, each in its thread's workspace, give the costs worked out by hand on the plan
+    // of KleeneIriConcatTest. Cost (card): <1>/<2> (node 4) 8 (2), (<1>/<2>)+ (node 2) 14 (3), <3> 3 (3), and the
+    // query (node 0) 23 (4); middleDivIn is 1 at the concat (node 1), whose cost is min(plan1, plan2) + 3 + 3
+    string dataDir = "../test_data/ReplanWithMaterializeTestSuite/";
+    auto csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph(dataDir + "KleeneIriConcatTest_graph.txt");
+    AndOrDag aod(csrPtr);
+    buildReplanTestDag(aod, dataDir);
+    const auto &q2idx = aod.getQ2idx();
+    ASSERT_EQ(q2idx.at("(<1>/<2>)+/<3>"), 0);
+    ASSERT_EQ(q2idx.at("(<1>/<2>)+"), 2);
+    ASSERT_EQ(q2idx.at("<1>/<2>"), 4);
+    map<size_t, pair<map<size_t, float>, float>> expected({
+        // As in KleeneIriConcatTest_expected_output.txt
+        {4, {{{4, 2}, {3, 8}, {2, 8}, {1, 17}, {0, 17}}, 6}},
+        // Concat: min(3 + 3 * 2 / 2, 3 + 3 * 1) + 3 + 3
+        {2, {{{2, 3}, {1, 12}, {0, 12}}, 11}},
+        {0, {{{0, 4}}, 19}}});
+    vector<size_t> candIdx;
+    for (size_t i = 0; i < 32; i++)
+        for (const auto &pr : expected)
+            candIdx.emplace_back(pr.first);
+    vector<float> prevCost(aod.getCost());
+    vector<bool> prevLeft2Right;
+    for (const auto &node : aod.getNodes())
+        prevLeft2Right.emplace_back(node.getLeft2Right());
+    vector<ReplanResult> results;
+    aod.replanCandidates(candIdx, results);
+    ASSERT_EQ(results.size(), candIdx.size());
+    for (size_t i = 0; i < candIdx.size(); i++) {
+        const auto &exp = expected.at(candIdx[i]);
+        map<size_t, float> node2cost(results[i].node2cost.begin(), results[i].node2cost.end());
+        ASSERT_EQ(node2cost.size(), exp.first.size()) << candIdx[i];
+        for (const auto &pr : exp.first) {
+            ASSERT_EQ(node2cost.count(pr.first), 1) << candIdx[i];
+            EXPECT_FLOAT_EQ(node2cost[pr.first], pr.second) << candIdx[i];
+        }
+        EXPECT_FLOAT_EQ(results[i].reducedCost, exp.second) << candIdx[i];
+    }
+    // Replanning leaves the dag as planned, including the Kleene execution modes
+    EXPECT_EQ(aod.getCost(), prevCost);
+    for (size_t i = 0; i < aod.getNumNodes(); i++)
+        EXPECT_EQ(aod.getNodes()[i].getLeft2Right(), prevLeft2Right[i]) << i;
+}
+
+TEST(ChooseMatViewsBatchTestSuite, SameSelectionTest) {
+    // Replanning stale candidates in parallel batches selects the same views, in the same order, as one at a time
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    AndOrDag aod(csrPtr);
+    for (const auto &q : {"<1>/<2>/<3>", "(<1>/<2>)+/<3>", "(<1>|<2>)*/<3>", "<2>/<3>/<3->", "((<1>/<2>)*|<3>)/<3>"})
+        aod.addWorkloadQuery(q, 1);
+    aod.initAuxiliary();
+    aod.annotateLeafCostCard();
+    aod.plan();
+    for (size_t budget : {size_t(4), size_t(16), std::numeric_limits<size_t>::max()}) {
+        AndOrDag serialAod(aod), batchAod(aod);
+        serialAod.setReplanBatch(1);
+        batchAod.setReplanBatch(4);
+        string serialOut, batchOut;
+        size_t serialSpace = 0, batchSpace = 0;
+        float serialBenefit = serialAod.chooseMatViews(0, serialSpace, budget, &serialOut);
+        float batchBenefit = batchAod.chooseMatViews(0, batchSpace, budget, &batchOut);
+        EXPECT_EQ(serialOut, batchOut);
+        EXPECT_FLOAT_EQ(serialBenefit, batchBenefit);
+        EXPECT_EQ(serialSpace, batchSpace);
+        for (size_t i = 0; i < aod.getNumNodes(); i++) {
+            EXPECT_EQ(serialAod.isMaterialized(i), batchAod.isMaterialized(i));
+            EXPECT_FLOAT_EQ(serialAod.getCost()[i], batchAod.getCost()[i]);
+        }
+    }
+}
+
 TEST_P(ChooseMatViewsTestSuite, KleeneIriConcatTest) {
     string testOutput;
     const auto &curParam = GetParam();
@@ -619,6 +837,21 @@ MappedCSR *resCsrPtr, bool explicitEpsilon=false) {
     }
 }
 
+// The (source, target) pairs of a result, to compare results of different engines or plans
+set<pair<unsigned, unsigned>> toPairs(const MappedCSR &res) {
+    set<pair<unsigned, unsigned>> ret;
+    for (const auto &pr : res.v2idx) {
+        size_t adjStart = res.offset[pr.second], adjEnd = pr.second < res.n - 1 ? res.offset[pr.second + 1] : res.adj.size();
+        for (size_t i = adjStart; i < adjEnd; i++)
+            ret.emplace(pr.first, res.adj[i]);
+    }
+    return ret;
+}
+
+set<pair<unsigned, unsigned>> toPairs(const QueryResult &qr) {
+    return toPairs(*qr.csrPtr);
+}
+
 TEST_P(ExecuteTestSuite, ExecuteTest) {
     const auto &pr = GetParam();
     const string &testName = pr.first;
@@ -697,6 +930,902 @@ TEST_P(ExecuteTestSuite, NfaExecuteTest) {
     compareExecuteResult(expectedOutputFileName, csrPtr.get(), res.get(), true);
 }
 
+TEST_P(ExecuteTestSuite, GlushkovExecuteTest) {
+    const auto &pr = GetParam();
+    const string &testName = pr.first;
+    string queryFileName = dataDir + testName + "_query.txt";
+    std::ifstream queryFile(queryFileName);
+    ASSERT_EQ(queryFile.is_open(), true);
+    string q;
+    queryFile >> q;
+    queryFile.close();
+    Rpq2NFAConvertor cvrt;
+    shared_ptr<NFA> nfaPtr = cvrt.convertGlushkov(q), dfaPtr = cvrt.convert(q)->convert2Dfa();
+    // One state per label occurrence plus the initial state, and no eps transitions
+    EXPECT_EQ(nfaPtr->states.size(), count(q.begin(), q.end(), '<') + 1);
+    for (const auto &state : nfaPtr->states)
+        for (const auto &tr : state->outEdges)
+            EXPECT_NE(tr.lbl, -1);
+    EXPECT_EQ(nfaPtr->initial->accept, dfaPtr->initial->accept);
+    EXPECT_TRUE(nfaPtr->sameNonEmptyLanguage(*dfaPtr));
+    shared_ptr<MappedCSR> res = nfaPtr->execute(csrPtr);
+    string expectedOutputFileName = dataDir + testName + "_expected_output.txt";
+    compareExecuteResult(expectedOutputFileName, csrPtr.get(), res.get(), true);
+}
+
+TEST_P(ExecuteTestSuite, BitParallelExecuteTest) {
+    const auto &pr = GetParam();
+    const string &testName = pr.first;
+    string queryFileName = dataDir + testName + "_query.txt";
+    std::ifstream queryFile(queryFileName);
+    ASSERT_EQ(queryFile.is_open(), true);
+    string q;
+    queryFile >> q;
+    queryFile.close();
+    Rpq2NFAConvertor cvrt;
+    shared_ptr<MappedCSR> res = cvrt.convertGlushkov(q)->executeBitParallel(csrPtr);
+    string expectedOutputFileName = dataDir + testName + "_expected_output.txt";
+    compareExecuteResult(expectedOutputFileName, csrPtr.get(), res.get(), true);
+}
+
+TEST_P(ExecuteTestSuite, LazyDfaExecuteTest) {
+    const auto &pr = GetParam();
+    const string &testName = pr.first;
+    string queryFileName = dataDir + testName + "_query.txt";
+    std::ifstream queryFile(queryFileName);
+    ASSERT_EQ(queryFile.is_open(), true);
+    string q;
+    queryFile >> q;
+    queryFile.close();
+    Rpq2NFAConvertor cvrt;
+    shared_ptr<NFA> nfaPtr = cvrt.convert(q);
+    string expectedOutputFileName = dataDir + testName + "_expected_output.txt";
+    // A cache of one state is flushed before almost every source
+    for (size_t maxCachedStates : {size_t(1024), size_t(1)}) {
+        shared_ptr<MappedCSR> res = nfaPtr->executeLazyDfa(csrPtr, maxCachedStates);
+        compareExecuteResult(expectedOutputFileName, csrPtr.get(), res.get(), true);
+    }
+}
+
+TEST_P(ExecuteTestSuite, DirectionExecuteTest) {
+    const auto &pr = GetParam();
+    const string &testName = pr.first;
+    string queryFileName = dataDir + testName + "_query.txt";
+    std::ifstream queryFile(queryFileName);
+    ASSERT_EQ(queryFile.is_open(), true);
+    string q;
+    queryFile >> q;
+    queryFile.close();
+    Rpq2NFAConvertor cvrt;
+    string expectedOutputFileName = dataDir + testName + "_expected_output.txt";
+    shared_ptr<MappedCSR> res = cvrt.convert(q)->convert2Dfa()->executeCheaperDirection(csrPtr);
+    compareExecuteResult(expectedOutputFileName, csrPtr.get(), res.get(), true);
+    // Whichever direction is cheaper, the reversed automaton gives the flipped pairs
+    shared_ptr<NFA> nfaPtr = cvrt.convertGlushkov(q);
+    if (!nfaPtr->initial->accept) {
+        MappedCSR flipped;
+        flipped.assignAsTranspose(*nfaPtr->reversed()->execute(csrPtr));
+        compareExecuteResult(expectedOutputFileName, csrPtr.get(), &flipped, true);
+    }
+}
+
+extern std::vector<std::string> executeTestNames;
+
+TEST_P(ExecuteTestSuite, BatchExecuteTest) {
+    // The query in a batch with all the test queries, itself twice with the same automaton
+    const auto &pr = GetParam();
+    const string &testName = pr.first;
+    Rpq2NFAConvertor cvrt;
+    vector<shared_ptr<NFA>> nfaPtrs;
+    vector<const NFA *> batch;
+    vector<size_t> selfPos;
+    for (const auto &name : executeTestNames) {
+        std::ifstream queryFile(dataDir + name + "_query.txt");
+        ASSERT_EQ(queryFile.is_open(), true);
+        string q;
+        queryFile >> q;
+        nfaPtrs.emplace_back(cvrt.convert(q));
+        for (size_t j = 0; j < (name == testName ? 2 : 1); j++) {
+            if (name == testName)
+                selfPos.emplace_back(batch.size());
+            batch.emplace_back(nfaPtrs.back().get());
+        }
+    }
+    string expectedOutputFileName = dataDir + testName + "_expected_output.txt";
+    for (size_t maxCachedStates : {size_t(1024), size_t(1)}) {
+        vector<shared_ptr<MappedCSR>> res = NFA::executeBatch(batch, csrPtr, maxCachedStates);
+        ASSERT_EQ(res.size(), batch.size());
+        for (size_t k : selfPos)
+            compareExecuteResult(expectedOutputFileName, csrPtr.get(), res[k].get(), true);
+    }
+}
+
+TEST_P(ExecuteTestSuite, ReachIdxExecuteTest) {
+    const auto &pr = GetParam();
+    const string &testName = pr.first;  // Kleene views are always materialized as reachability indices
+    string inputFileName = dataDir + testName + "_input.txt";
+    string queryFileName = dataDir + testName + "_query.txt";
+    std::ifstream queryFile(queryFileName);
+    ASSERT_EQ(queryFile.is_open(), true);
+    string q;
+    queryFile >> q;
+    queryFile.close();
+    string expectedOutputFileName = dataDir + testName + "_expected_output.txt";
+    for (bool l2r : {true, false}) {
+        AndOrDag aod;
+        aod.setCsrPtr(csrPtr);
+        buildAndOrDagFromFile(aod, inputFileName, testName == "ConcatTest", l2r);
+        aod.initAuxiliary();
+        aod.setUseReachIdx(true);
+        for (size_t i = 0; i < aod.getNumNodes(); i++) {
+            if (aod.isKleeneView(i)) {
+                aod.setCard(i, numeric_limits<size_t>::max());  // Make the index smaller than the pairs
+                aod.setMaterialized(i);
+            }
+        }
+        aod.materialize();
+        QueryResult qr(nullptr, false);
+        aod.execute(q, qr);
+        compareExecuteResult(expectedOutputFileName, csrPtr.get(), qr.csrPtr, false);
+        if (qr.newed)
+            delete qr.csrPtr;
+    }
+}
+
+TEST(ExecuteAdHocTestSuite, ViewReuseTest) {
+    // Queries outside the dag are answered on top of its views, and the dag is left as before
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    AndOrDag aod(csrPtr);
+    for (const auto &q : {"<1>/<2>/<3>", "(<1>/<2>)+/<3>", "<1>", "<2>/<3>/<3->"})
+        aod.addWorkloadQuery(q, 1);
+    aod.initAuxiliary();
+    aod.annotateLeafCostCard();
+    aod.plan();
+    size_t usedSpace = 0;
+    aod.chooseMatViews(0, usedSpace);
+    aod.materialize();
+    size_t numNodes = aod.getNumNodes();
+    auto q2idx = aod.getQ2idx();
+    size_t numEstimates = aod.getEstimateCache().size(), numMisses = aod.getEstimateCacheMiss();
+    vector<int> topoOrder;
+    vector<size_t> numParents;
+    for (const auto &node : aod.getNodes()) {
+        topoOrder.emplace_back(node.getTopoOrder());
+        numParents.emplace_back(node.getParentIdx().size());
+    }
+
+    // The last two are spelled differently from the queries in the dag, but name their nodes
+    for (const auto &q : {"(<1>/<2>)+/<3>/<3->", "<1>*/<2>", "(<1>/<2>)|<3->", "(<1>|<3>)+", "<1>/(<2>|<3>)",
+        "<1>/<2>/<3>", "((<1>/<2>)+)/<3>", "<1>/(<2>/<3>)"}) {
+        AndOrDag aodRef(csrPtr);
+        aodRef.addWorkloadQuery(q, 1);
+        aodRef.initAuxiliary();
+        aodRef.annotateLeafCostCard();
+        aodRef.plan();
+        QueryResult qr(nullptr, false), qrRef(nullptr, false);
+        aod.executeAdHoc(q, qr);
+        aodRef.execute(q, qrRef);
+        ASSERT_NE(qr.csrPtr, nullptr);
+        EXPECT_EQ(toPairs(qr), toPairs(qrRef));
+        EXPECT_EQ(qr.hasEpsilon, qrRef.hasEpsilon);
+        if (qr.newed)
+            delete qr.csrPtr;
+        if (qrRef.newed)
+            delete qrRef.csrPtr;
+
+        ASSERT_EQ(aod.getNumNodes(), numNodes);
+        EXPECT_EQ(aod.getQ2idx(), q2idx) << q;
+        // Estimates of old nodes may stay, but none keyed by a removed index (see estimateKey)
+        for (const auto &pr : aod.getEstimateCache())
+            EXPECT_LT(stoul(pr.first.substr(0, pr.first.find(' '))), numNodes) << q;
+        for (size_t i = 0; i < numNodes; i++) {
+            EXPECT_EQ(aod.getNodes()[i].getTopoOrder(), topoOrder[i]);
+            EXPECT_EQ(aod.getNodes()[i].getParentIdx().size(), numParents[i]);
+        }
+    }
+    EXPECT_LT(aod.getEstimateCache().size() - numEstimates, aod.getEstimateCacheMiss() - numMisses);
+
+    // Old nodes left unplanned (cost 0) are planned for the query, but keep their plans afterwards
+    size_t idx = q2idx.at("<2>/<3>");
+    aod.setCost(idx, 0);
+    vector<float> oldCost = aod.getCost();
+    vector<size_t> oldCard = aod.getCard(), oldSrcCnt = aod.getSrcCnt(), oldDstCnt = aod.getDstCnt();
+    vector<bool> oldMaterialized = aod.getMaterialized();
+    vector<size_t> oldTargetChild;
+    for (const auto &node : aod.getNodes())
+        oldTargetChild.emplace_back(node.getTargetChild());
+    QueryResult qr(nullptr, false);
+    aod.executeAdHoc("<2>/<3>/<1->", qr);
+    if (qr.newed)
+        delete qr.csrPtr;
+    ASSERT_EQ(aod.getNumNodes(), numNodes);
+    EXPECT_EQ(aod.getCost(), oldCost);
+    EXPECT_EQ(aod.getCard(), oldCard);
+    EXPECT_EQ(aod.getSrcCnt(), oldSrcCnt);
+    EXPECT_EQ(aod.getDstCnt(), oldDstCnt);
+    EXPECT_EQ(aod.getMaterialized(), oldMaterialized);
+    for (size_t i = 0; i < numNodes; i++)
+        EXPECT_EQ(aod.getNodes()[i].getTargetChild(), oldTargetChild[i]);
+}
+
+TEST(ExecuteAdHocTestSuite, ViewMatchTest) {
+    // Queries outside the dag are answered by the views of equivalent ones, and the classes are left as before
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    AndOrDag aod(csrPtr);
+    aod.setUseViewMatch(true);
+    for (const auto &q : {"<1>+", "<1>*/<2>", "<2>/<3>"})
+        aod.addWorkloadQuery(q, 1);
+    aod.initAuxiliary();
+    aod.annotateLeafCostCard();
+    aod.plan();
+    aod.setMaterialized(aod.getQ2idx().at("<1>+"));
+    aod.materialize();
+    size_t numNodes = aod.getNumNodes();
+    vector<size_t> equivRoot = aod.getEquivRoot();
+    vector<int> answering;
+    for (size_t i = 0; i < numNodes; i++)
+        answering.emplace_back(aod.answeringView(i));
+
+    for (const auto &q : {"(<1>|<1>)+", "<1>/<1>*/<2>", "(<1>+)+/<3>", "<1>*/<1>|<2>"}) {
+        AndOrDag aodRef(csrPtr);
+        aodRef.addWorkloadQuery(q, 1);
+        aodRef.initAuxiliary();
+        aodRef.annotateLeafCostCard();
+        aodRef.plan();
+        QueryResult qr(nullptr, false), qrRef(nullptr, false);
+        aod.executeAdHoc(q, qr);
+        aodRef.execute(q, qrRef);
+        ASSERT_NE(qr.csrPtr, nullptr);
+        EXPECT_EQ(toPairs(qr), toPairs(qrRef)) << q;
+        EXPECT_EQ(qr.hasEpsilon, qrRef.hasEpsilon) << q;
+        if (qr.newed)
+            delete qr.csrPtr;
+        if (qrRef.newed)
+            delete qrRef.csrPtr;
+
+        ASSERT_EQ(aod.getNumNodes(), numNodes);
+        EXPECT_EQ(aod.getEquivRoot(), equivRoot) << q;
+        for (size_t i = 0; i < numNodes; i++)
+            EXPECT_EQ(aod.answeringView(i), answering[i]) << q;
+    }
+}
+
+TEST(ViewMatchTestSuite, EquivalentQueryTest) {
+    // Views answer equivalent queries, adding back the empty path if needed
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    vector<string> equivQueries({"<1>+", "<1>*", "<1>/<1>*", "<1>*/<1>", "(<1>)+", "(<1>|<1>)+"});
+    vector<string> queries(equivQueries);
+    queries.emplace_back("<1>/<1>+");
+    auto buildDag = [&](AndOrDag &aod, bool useViewMatch) {
+        aod.setUseViewMatch(useViewMatch);
+        for (const auto &q : queries)
+            aod.addWorkloadQuery(q, 1);
+        aod.initAuxiliary();
+        aod.annotateLeafCostCard();
+        aod.plan();
+    };
+    AndOrDag aodRef(csrPtr);
+    buildDag(aodRef, false);
+    auto checkResults = [&](AndOrDag &aod) {
+        for (const auto &q : queries) {
+            QueryResult qr(nullptr, false), qrRef(nullptr, false);
+            aod.execute(q, qr);
+            aodRef.execute(q, qrRef);
+            ASSERT_NE(qr.csrPtr, nullptr);
+            EXPECT_EQ(toPairs(qr), toPairs(qrRef)) << q;
+            EXPECT_EQ(qr.hasEpsilon, qrRef.hasEpsilon) << q;
+            if (qr.newed)
+                delete qr.csrPtr;
+            if (qrRef.newed)
+                delete qrRef.csrPtr;
+        }
+    };
+
+    // A view of <1>+ answers all but <1>/<1>+
+    AndOrDag aod(csrPtr);
+    buildDag(aod, true);
+    const auto &q2idx = aod.getQ2idx();
+    size_t viewIdx = q2idx.at("<1>+");
+    aod.setMaterialized(viewIdx);
+    aod.materialize();
+    // (<1>)+ is the same node as <1>+
+    EXPECT_EQ(q2idx.at("(<1>)+"), viewIdx);
+    for (const auto &q : equivQueries)
+        EXPECT_EQ(aod.answeringView(q2idx.at(q)), q2idx.at(q) == viewIdx ? -1 : int(viewIdx)) << q;
+    EXPECT_EQ(aod.answeringView(q2idx.at("<1>/<1>+")), -1);
+    // The automata compared by matching are not stored into the nodes
+    for (const auto &q : queries)
+        EXPECT_EQ(aod.getNodes()[q2idx.at(q)].getDfaPtr(), nullptr) << q;
+    checkResults(aod);
+
+    // A view of <1>* cannot answer those without the empty path
+    AndOrDag aodStar(csrPtr);
+    buildDag(aodStar, true);
+    viewIdx = aodStar.getQ2idx().at("<1>*");
+    aodStar.setMaterialized(viewIdx);
+    aodStar.materialize();
+    for (const auto &q : equivQueries)
+        EXPECT_EQ(aodStar.answeringView(aodStar.getQ2idx().at(q)), -1) << q;
+
+    // Greedy selection counts the equivalent queries, so each query is materialized or answered by a view
+    AndOrDag aodChosen(csrPtr);
+    buildDag(aodChosen, true);
+    size_t usedSpace = 0;
+    aodChosen.chooseMatViews(0, usedSpace);
+    aodChosen.materialize();
+    size_t numViews = 0;
+    for (const auto &q : equivQueries) {
+        size_t idx = aodChosen.getQ2idx().at(q);
+        if (aodChosen.isMaterialized(idx))
+            numViews++;
+        else
+            EXPECT_NE(aodChosen.answeringView(idx), -1) << q;
+    }
+    EXPECT_LE(numViews, 2);
+    checkResults(aodChosen);
+}
+
+TEST(NormalizeTestSuite, RewriteTest) {
+    vector<pair<string, string>> q2normalized({{"(<1>|<2>)", "<1>|<2>"}, {"(<2>|<1>)", "<1>|<2>"}, {"((<1>))|<2>", "<1>|<2>"},
+        {"<2>|<1>|<2>", "<1>|<2>"}, {"<3>|(<2>|<1>/<2>)", "<1>/<2>|<2>|<3>"}, {"(<2>|<1>)/<3>", "(<1>|<2>)/<3>"},
+        {"(<1>*)*", "<1>*"}, {"(<1>?)*", "<1>*"}, {"(<1>+)?", "<1>*"}, {"((<1>+)+)", "<1>+"}, {"(<1>?)?", "<1>?"},
+        {"<1>/<1>*", "<1>+"}, {"<1>*/<1>", "<1>+"}, {"<1->/(<1->)*", "<1->+"}, {"<3>/<1>/<2>/(<1>/<2>)*", "<3>/(<1>/<2>)+"},
+        {"(<1>/<2>)*/<1>/<2>/<3>", "(<1>/<2>)+/<3>"}, {"<1>/<1>+", "<1>/<1>+"}, {"((<2>|<1>)*)*/<3>", "(<1>|<2>)*/<3>"}});
+    for (const auto &pr : q2normalized) {
+        EXPECT_EQ(RpqAst::normalize(pr.first), pr.second) << pr.first;
+        EXPECT_EQ(RpqAst::normalize(pr.second), pr.second) << pr.second;
+    }
+}
+
+TEST(NormalizeTestSuite, SharingTest) {
+    // Spellings of the same query share one node, and give the same results as without normalization
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    vector<string> queries({"(<1>|<2>)/<3>", "(<2>|<1>)/<3>", "((<1>))|<2>", "<2>|<1>", "<1>/<1>*", "<1>+", "(<2>?)*/<3>"});
+    AndOrDag aod(csrPtr), aodRaw(csrPtr);
+    aod.setNormalizeQueries(true);
+    for (AndOrDag *aodPtr : {&aod, &aodRaw}) {
+        for (const auto &q : queries)
+            aodPtr->addWorkloadQuery(q, 1);
+        aodPtr->initAuxiliary();
+        aodPtr->annotateLeafCostCard();
+        aodPtr->plan();
+    }
+    const auto &q2idx = aod.getQ2idx();
+    EXPECT_EQ(q2idx.at("(<1>|<2>)/<3>"), q2idx.at(aod.queryKey("(<2>|<1>)/<3>")));
+    EXPECT_EQ(q2idx.at("<1>|<2>"), q2idx.at(aod.queryKey("((<1>))|<2>")));
+    EXPECT_EQ(q2idx.at("<1>+"), q2idx.at(aod.queryKey("<1>/<1>*")));
+    EXPECT_EQ(q2idx.count("(<2>|<1>)/<3>"), 0);
+    EXPECT_LT(aod.getNumNodes(), aodRaw.getNumNodes());
+    EXPECT_EQ(aod.getWorkloadFreq()[q2idx.at("<1>|<2>")], 2);
+    for (const auto &q : queries) {
+        QueryResult qr(nullptr, false), qrRaw(nullptr, false);
+        aod.execute(q, qr);
+        aodRaw.execute(q, qrRaw);
+        ASSERT_NE(qr.csrPtr, nullptr);
+        EXPECT_EQ(toPairs(qr), toPairs(qrRaw)) << q;
+        EXPECT_EQ(qr.hasEpsilon, qrRaw.hasEpsilon) << q;
+        if (qr.newed)
+            delete qr.csrPtr;
+        if (qrRaw.newed)
+            delete qrRaw.csrPtr;
+    }
+}
+
+TEST(ParserTestSuite, ParseTest) {
+    RpqAst ast;
+    ast.parse("(<12->|<3>)*/<0>?");
+    const auto &nodes = ast.getNodes();
+    size_t root = ast.getRoot();
+    ASSERT_EQ(nodes[root].type, '/');
+    ASSERT_EQ(nodes[root].numChildren, 2);
+    size_t star = ast.getChildren(root)[0], alt = ast.getChildren(star)[0];
+    EXPECT_EQ(nodes[star].type, '*');
+    ASSERT_EQ(nodes[alt].type, '|');
+    size_t lbl = ast.getChildren(alt)[0];
+    EXPECT_EQ(nodes[lbl].type, 'l');
+    EXPECT_EQ(nodes[lbl].lbl, 12);
+    EXPECT_TRUE(nodes[lbl].inv);
+    EXPECT_EQ(ast.toString(), "(<12->|<3>)*/<0>?");
+    // Parsing again reuses the arena
+    ast.parse("((<1>))");
+    EXPECT_EQ(ast.getNodes().size(), 1);
+    EXPECT_EQ(ast.toString(), "<1>");
+    for (const string q : {"", "<1", "<a>", "<1>**", "(<1>", "<1>)", "<1>/", "|<1>", "<1> ", "<-1>", "()"})
+        EXPECT_THROW(ast.parse(q), std::runtime_error) << q;
+}
+
+TEST(GlushkovTestSuite, SameLanguageTest) {
+    // The position automaton accepts the same paths as the Thompson automaton, including on nested closures
+    Rpq2NFAConvertor cvrt;
+    for (const string q : {"(<1>*)*", "((<1>?)/(<2>?))+", "<1>/(<2>|<3>*)?/<1->", "(<1>|<2>/<3>)*/<2>", "(<1>+|<2>?)/(<3>/<1>)+"}) {
+        shared_ptr<NFA> nfaPtr = cvrt.convertGlushkov(q), dfaPtr = cvrt.convert(q)->convert2Dfa();
+        EXPECT_EQ(nfaPtr->initial->accept, dfaPtr->initial->accept) << q;
+        EXPECT_TRUE(nfaPtr->sameNonEmptyLanguage(*dfaPtr)) << q;
+    }
+}
+
+TEST(BitParallelTestSuite, ManyStatesTest) {
+    // More states than a machine word holds, and nondeterministic states, give the same pairs as the DFA
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    string longQ = "(";
+    for (size_t i = 0; i < 70; i++)
+        longQ += (i > 0 ? "|<" : "<") + to_string(i % 3 + 1) + (i % 4 == 3 ? "->" : ">") + (i % 5 == 0 ? "/<2>" : "");
+    longQ += ")*/<3>";
+    Rpq2NFAConvertor cvrt;
+    for (const string &q : {longQ, string("(<1>|<1>/<2>)+/<2>?"), string("<1>/(<2>|<3>*)?/<1->")}) {
+        shared_ptr<NFA> nfaPtr = cvrt.convertGlushkov(q);
+        shared_ptr<MappedCSR> res = nfaPtr->executeBitParallel(csrPtr), expected = cvrt.convert(q)->convert2Dfa()->execute(csrPtr);
+        EXPECT_EQ(toPairs(*res), toPairs(*expected)) << q;
+        EXPECT_EQ(res->adj.size(), toPairs(*res).size()) << q;  // No duplicate pairs
+    }
+    EXPECT_GT(cvrt.convertGlushkov(longQ)->states.size(), 64);
+}
+
+TEST(LazyDfaTestSuite, CacheFlushTest) {
+    // Thompson automata (with eps transitions) give the same pairs as their DFA, with or without cache flushes
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    Rpq2NFAConvertor cvrt;
+    for (const string q : {"(<1>|<1>/<2>)+/<2>?", "<1>/(<2>|<3>*)?/<1->", "((<1>?)/(<2>?))+", "(<3->|<2>)*/<1->"}) {
+        shared_ptr<NFA> nfaPtr = cvrt.convert(q);
+        shared_ptr<MappedCSR> expected = nfaPtr->convert2Dfa()->execute(csrPtr);
+        for (size_t maxCachedStates : {size_t(0), size_t(2), size_t(1024)}) {
+            shared_ptr<MappedCSR> res = nfaPtr->executeLazyDfa(csrPtr, maxCachedStates);
+            EXPECT_EQ(toPairs(*res), toPairs(*expected)) << q;
+            EXPECT_EQ(res->adj.size(), toPairs(*res).size()) << q;
+        }
+    }
+}
+
+TEST(BatchTestSuite, SharedPrefixTest) {
+    // Queries sharing prefixes, accepting the empty path from different sources, and repeated
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    Rpq2NFAConvertor cvrt;
+    vector<string> queries({"<1>/<2>", "<1>/<2>*", "<3>?", "<1>/<2>/<3>", "<2->/<1->", "(<1>|<3>)*"});
+    vector<shared_ptr<NFA>> nfaPtrs;
+    vector<const NFA *> batch;
+    for (const auto &q : queries) {
+        nfaPtrs.emplace_back(cvrt.convertGlushkov(q));
+        batch.emplace_back(nfaPtrs.back().get());
+    }
+    batch.emplace_back(nfaPtrs[0].get());
+    vector<shared_ptr<MappedCSR>> res = NFA::executeBatch(batch, csrPtr);
+    ASSERT_EQ(res.size(), batch.size());
+    for (size_t k = 0; k < batch.size(); k++) {
+        const string &q = queries[k < queries.size() ? k : 0];
+        shared_ptr<MappedCSR> expected = cvrt.convert(q)->convert2Dfa()->execute(csrPtr);
+        EXPECT_EQ(toPairs(*res[k]), toPairs(*expected)) << q;
+        EXPECT_EQ(res[k]->adj.size(), toPairs(*res[k]).size()) << q;
+    }
+}
+
+TEST(DirectionTestSuite, CheaperBackwardTest) {
+    // Two vertices each start a <1>-, <2>- and <3>-edge; two end a <1>-edge, and three a <3>-edge
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    Rpq2NFAConvertor cvrt;
+    EXPECT_FALSE(cvrt.convertGlushkov("<1>/(<2>|<3>)*")->cheaperBackward(*csrPtr));
+    EXPECT_TRUE(cvrt.convertGlushkov("(<1>|<2>|<3>)*/<1>")->cheaperBackward(*csrPtr));
+    EXPECT_FALSE(cvrt.convertGlushkov("(<1>|<2>|<3>)*")->cheaperBackward(*csrPtr));   // Accepts the empty path
+    for (const string q : {"(<1>|<2>|<3>)*/<1>", "(<1>|<2>)*/<3>", "<1>/<2>/<3>", "(<2->|<3>)+/<2>"}) {
+        shared_ptr<NFA> dfaPtr = cvrt.convert(q)->convert2Dfa();
+        shared_ptr<MappedCSR> expected = dfaPtr->execute(csrPtr), res = dfaPtr->executeCheaperDirection(csrPtr);
+        EXPECT_TRUE(*res == *expected) << q;
+    }
+}
+
+TEST(ClosureTestSuite, PushPullTest) {
+    // Closures over a dense random graph, so that the BFS switches to pulling, give the same pairs as the NFA
+    string graphFilePath = "ClosureTestSuite_PushPullTest_graph.txt";
+    std::ofstream graphFile(graphFilePath);
+    ASSERT_EQ(graphFile.is_open(), true);
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<unsigned> dist(0, 599);
+    for (size_t i = 0; i < 2400; i++)
+        graphFile << dist(gen) << " " << dist(gen) << " 1\n";
+    for (size_t i = 0; i < 300; i++)
+        graphFile << dist(gen) << " " << dist(gen) << " 2\n";
+    graphFile.close();
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph(graphFilePath);
+    remove(graphFilePath.c_str());
+    Rpq2NFAConvertor cvrt;
+    int lbl = 0;
+    bool forward = true;
+    for (const string q : {"<1>*", "<1>+", "<1>/<1>*", "(<1>|<1>)+", "<2->*"}) {
+        shared_ptr<NFA> dfaPtr = cvrt.convert(q)->convert2Dfa();
+        EXPECT_TRUE(dfaPtr->isSingleLabelClosure(lbl, forward)) << q;
+        EXPECT_EQ(forward, q[2] != '-') << q;
+        shared_ptr<MappedCSR> res = dfaPtr->execute(csrPtr);
+        shared_ptr<MappedCSR> expected = cvrt.convertGlushkov(q)->executeBitParallel(csrPtr);
+        EXPECT_EQ(toPairs(*res), toPairs(*expected)) << q;
+        EXPECT_EQ(res->adj.size(), toPairs(*res).size()) << q;
+    }
+    for (const string q : {"<1>?", "(<1>/<1>)*", "<1>*/<2>", "<1>/<1>+", "<1>*|<2>"})
+        EXPECT_FALSE(cvrt.convert(q)->convert2Dfa()->isSingleLabelClosure(lbl, forward)) << q;
+}
+
+TEST(ReachIndexTestSuite, ClosureTest) {
+    // 0->1->2->0 (SCC), 2->3, 3->3 (self loop), 4->3, 5 -> 4
+    MappedCSR rel;
+    vector<pair<unsigned, unsigned>> edges({{0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 3}, {4, 3}, {5, 4}});
+    for (const auto &e : edges) {
+        if (rel.v2idx.find(e.first) == rel.v2idx.end()) {
+            rel.v2idx[e.first] = rel.offset.size();
+            rel.offset.emplace_back(rel.adj.size());
+        }
+        rel.adj.emplace_back(e.second);
+    }
+    rel.n = rel.offset.size();
+    rel.m = rel.adj.size();
+    ReachIndex reachIdx;
+    reachIdx.build(rel);
+    unordered_map<unsigned, unordered_set<unsigned>> expected({{0, {0, 1, 2, 3}}, {1, {0, 1, 2, 3}}, {2, {0, 1, 2, 3}},
+        {3, {3}}, {4, {3}}, {5, {3, 4}}});
+    for (unsigned u = 0; u < 6; u++)
+        for (unsigned v = 0; v < 6; v++)
+            EXPECT_EQ(reachIdx.reach(u, v), expected[u].find(v) != expected[u].end());
+    MappedCSR res;
+    reachIdx.expandAll(res);
+    EXPECT_EQ(res.n, 6);
+    AdjInterval aitv;
+    for (unsigned u = 0; u < 6; u++) {
+        res.getAdjIntervalByVert(u, aitv);
+        ASSERT_EQ(aitv.len, expected[u].size());
+        for (size_t j = 0; j < aitv.len; j++)
+            EXPECT_EQ(expected[u].find((*aitv.start)[aitv.offset + j]) != expected[u].end(), true);
+    }
+    MappedCSR revRes;
+    reachIdx.expand({3}, true, revRes);
+    EXPECT_EQ(revRes.n, 6);
+}
+
+TEST(LcrTestSuite, AlternationKleeneTest) {
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    vector<string> qVec({"(<1>|<2>)*", "(<2>|<1>)+", "(<1>|<3->)+", "(<1>|<2>)*/<3>", "<3>/(<1>|<2>)*"});
+    AndOrDag aod(csrPtr), aodLcr(csrPtr);
+    for (AndOrDag *aodPtr : {&aod, &aodLcr}) {
+        for (const auto &q : qVec)
+            aodPtr->addWorkloadQuery(q, 1);
+        aodPtr->initAuxiliary();
+        aodPtr->annotateLeafCostCard();
+        aodPtr->plan();
+    }
+    ASSERT_EQ(aodLcr.addLcrLabelSetsFromWorkload(), 2);
+    size_t numLcrViews = 0;
+    for (size_t i = 0; i < aodLcr.getNumNodes(); i++) {
+        if (aodLcr.isLcrView(i)) {
+            EXPECT_EQ(aodLcr.storeAsReachIdx(i), true);
+            aodLcr.setMaterialized(i);
+            numLcrViews++;
+        }
+    }
+    ASSERT_EQ(numLcrViews, 3);
+    aodLcr.materialize();
+    // Views over the same label set share one index
+    EXPECT_EQ(aodLcr.getNodes()[aodLcr.getQ2idx()["(<1>|<2>)*"]].getReachIdxPtr(),
+        aodLcr.getNodes()[aodLcr.getQ2idx()["(<2>|<1>)+"]].getReachIdxPtr());
+    for (const auto &q : qVec) {
+        QueryResult qr(nullptr, false), qrLcr(nullptr, false);
+        aod.execute(q, qr);
+        aodLcr.execute(q, qrLcr);
+        EXPECT_EQ(toPairs(qr), toPairs(qrLcr));
+        EXPECT_EQ(qr.hasEpsilon, qrLcr.hasEpsilon);
+        if (qr.newed)
+            delete qr.csrPtr;
+        if (qrLcr.newed)
+            delete qrLcr.csrPtr;
+    }
+}
+
+TEST(OnlineTestSuite, WorkloadTrackerTest) {
+    WorkloadTracker tracker(3);
+    for (const auto &q : {"<1>", "<2>", "<1>", "<3>"})
+        tracker.record(q);
+    EXPECT_EQ(tracker.size(), 3);
+    EXPECT_EQ(tracker.getQ2freq().count("<1>"), 1);
+    EXPECT_EQ(tracker.getQ2freq().at("<1>"), 1);  // The first <1> has left the window
+    EXPECT_EQ(tracker.getQ2freq().at("<2>"), 1);
+    EXPECT_EQ(tracker.getQ2freq().at("<3>"), 1);
+    tracker.record("<3>");
+    tracker.record("<3>");
+    EXPECT_EQ(tracker.getQ2freq().size(), 1);
+    EXPECT_EQ(tracker.getQ2freq().at("<3>"), 3);
+}
+
+TEST(OnlineTestSuite, ReselectTest) {
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    vector<string> qVec1({"<1>/<2>/<3>", "(<1>/<2>)+/<3>", "<2>/<3>/<3->"}), qVec2({"(<1>/<2>)+/<3>", "(<1>|<2>)*/<3>", "((<1>/<2>)*|<3>)/<3>"});
+    OnlineViewManager mgr(csrPtr, 6, std::numeric_limits<size_t>::max());
+    auto runAndCheck = [&](const vector<string> &qVec) {
+        AndOrDag aod(csrPtr);   // Reference: no views
+        for (const auto &q : qVec)
+            aod.addWorkloadQuery(q, 1);
+        aod.initAuxiliary();
+        aod.annotateLeafCostCard();
+        aod.plan();
+        for (const auto &q : qVec) {
+            QueryResult qr(nullptr, false), qrRef(nullptr, false);
+            auto snapshotPtr = mgr.execute(q, qr);
+            ASSERT_NE(snapshotPtr, nullptr);
+            aod.execute(q, qrRef);
+            EXPECT_EQ(toPairs(qr), toPairs(qrRef));
+            EXPECT_EQ(qr.hasEpsilon, qrRef.hasEpsilon);
+            if (qr.newed)
+                delete qr.csrPtr;
+            if (qrRef.newed)
+                delete qrRef.csrPtr;
+        }
+    };
+
+    // Before any selection, queries are answered by their DFAs
+    for (const auto &q : qVec1) {
+        QueryResult qr(nullptr, false);
+        EXPECT_EQ(mgr.execute(q, qr), nullptr);
+        ASSERT_NE(qr.csrPtr, nullptr);
+        delete qr.csrPtr;
+    }
+    ASSERT_TRUE(mgr.reselect(false));
+    EXPECT_EQ(mgr.getNumKept(), 0);
+    EXPECT_GT(mgr.getNumAdded(), 0);
+    runAndCheck(qVec1);
+
+    // The window now holds qVec1 and qVec2; views shared with the serving snapshot are kept
+    auto oldAodPtr = mgr.getAod();
+    runAndCheck(vector<string>({"(<1>/<2>)+/<3>"}));
+    for (const auto &q : qVec2) {
+        QueryResult qr(nullptr, false);
+        mgr.execute(q, qr);
+        if (qr.newed)
+            delete qr.csrPtr;
+    }
+    ASSERT_TRUE(mgr.reselect());
+    mgr.waitReselect();
+    EXPECT_NE(mgr.getAod(), oldAodPtr);
+    EXPECT_GT(mgr.getNumKept(), 0);
+    runAndCheck(qVec2);
+    const auto &newAod = *mgr.getAod();
+    for (const auto &pr : oldAodPtr->getQ2idx()) {
+        auto it = newAod.getQ2idx().find(pr.first);
+        if (oldAodPtr->isMaterialized(pr.second) && !oldAodPtr->getNodes()[pr.second].getChildIdx().empty()
+        && it != newAod.getQ2idx().end() && newAod.isMaterialized(it->second) && newAod.getNodes()[it->second].getReachIdxPtr() == nullptr) {
+            EXPECT_EQ(newAod.getNodes()[it->second].getRes().csrPtr, oldAodPtr->getNodes()[pr.second].getRes().csrPtr);
+        }
+    }
+}
+
+TEST(SamplingTestSuite, WithoutReplacementTest) {
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    for (const auto &lblCsr : csrPtr->outCsr) {
+        ASSERT_EQ(lblCsr.idx2v.size(), lblCsr.n);
+        for (const auto &pr : lblCsr.v2idx)
+            EXPECT_EQ(lblCsr.idx2v[pr.second], pr.first);
+    }
+    setRngSeed(42);
+    vector<size_t> sampled, sampledAgain;
+    sampleWithoutReplacement(1000, 100, sampled);
+    ASSERT_EQ(sampled.size(), 100);
+    EXPECT_EQ(unordered_set<size_t>(sampled.begin(), sampled.end()).size(), 100);
+    for (size_t x : sampled)
+        EXPECT_LT(x, 1000);
+    setRngSeed(42);
+    sampleWithoutReplacement(1000, 100, sampledAgain);
+    EXPECT_EQ(sampled, sampledAgain);
+    sampleWithoutReplacement(10, 100, sampled);
+    EXPECT_EQ(sampled.size(), 10);
+}
+
+TEST(SamplingTestSuite, AdaptiveEstimateTest) {
+    // 2000 <1>-edges i -> 10000 + i; the targets of the even ones have <2>-edges, so middleDivIn of <1>/<2> is 0.5
+    string graphFilePath = "SamplingTestSuite_AdaptiveEstimateTest_graph.txt";
+    std::ofstream graphFile(graphFilePath);
+    ASSERT_EQ(graphFile.is_open(), true);
+    for (size_t i = 0; i < 2000; i++) {
+        graphFile << i << " " << 10000 + i << " 1\n";
+        if (i % 2 == 0)
+            graphFile << 10000 + i << " " << 20000 + i << " 2\n";
+    }
+    graphFile.close();
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph(graphFilePath);
+    remove(graphFilePath.c_str());
+    AndOrDag aod(csrPtr);
+    aod.addWorkloadQuery("<1>/<2>", 1);
+    aod.initAuxiliary();
+    size_t lIdx = aod.getQ2idx()["<1>"], rIdx = aod.getQ2idx()["<2>"];
+    setRngSeed(7);
+    for (size_t i = 0; i < 5; i++) {
+        float middleDivIn = aod.approxMiddleDivInMonteCarlo(aod.getNodes()[lIdx].getEndLabel(), rIdx);
+        EXPECT_NEAR(middleDivIn, 0.5, 0.15);
+    }
+    // No target of a <2>-edge has <2>-edges
+    EXPECT_FLOAT_EQ(aod.approxMiddleDivInMonteCarlo(aod.getNodes()[rIdx].getEndLabel(), rIdx), 0);
+    // The automaton comes from the cache; estimation (run by concurrent planning tasks) does not write the node
+    EXPECT_EQ(aod.getNodes()[rIdx].getDfaPtr(), nullptr);
+    size_t numHits = AutomatonCache::instance().getNumHits();
+    aod.approxMiddleDivInMonteCarlo(aod.getNodes()[rIdx].getEndLabel(), rIdx);
+    EXPECT_GT(AutomatonCache::instance().getNumHits(), numHits);
+}
+
+TEST(StatisticsTestSuite, MiddleDivInTest) {
+    // Skewed degrees: 50 <1>-edges into vertex 100, which has a <2>-edge, and one <1>-edge into each of 101..103,
+    // which have none; the stats give the same fraction of end nodes (1/4) as probing all of them
+    string graphFilePath = "StatisticsTestSuite_MiddleDivInTest_graph.txt";
+    std::ofstream graphFile(graphFilePath);
+    ASSERT_EQ(graphFile.is_open(), true);
+    for (size_t i = 0; i < 50; i++)
+        graphFile << i << " 100 1\n";
+    for (size_t i = 101; i < 104; i++)
+        graphFile << i - 101 << " " << i << " 1\n";
+    graphFile << "100 200 2\n";
+    graphFile.close();
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph(graphFilePath);
+    remove(graphFilePath.c_str());
+    csrPtr->fillStats();
+    AndOrDag aod(csrPtr);
+    aod.addWorkloadQuery("<1>/<2>", 1);
+    aod.initAuxiliary();
+    size_t lIdx = aod.getQ2idx()["<1>"], rIdx = aod.getQ2idx()["<2>"];
+    float fromStats = 0;
+    ASSERT_TRUE(aod.middleDivInFromStats(aod.getNodes()[lIdx].getEndLabel(), rIdx, fromStats));
+    EXPECT_FLOAT_EQ(fromStats, 0.25);
+    EXPECT_FLOAT_EQ(aod.approxMiddleDivInMonteCarlo(aod.getNodes()[lIdx].getEndLabel(), rIdx), fromStats);
+}
+
+TEST(StatisticsTestSuite, SimpleTest) {
+    // Expected output format: #labels, then outCnt, inCnt, outCooccur, inCooccur, tgtOutCnt, tgtInCnt, srcOutCnt,
+    // srcInCnt indexed by the labels in the file
+    string dataDir = "../test_data/StatisticsTestSuite/";
+    MultiLabelCSR csr;
+    csr.loadGraph(dataDir + "SimpleTest_graph.txt");
+    csr.fillStats();
+    std::ifstream expectedOutputFile(dataDir + "SimpleTest_expected_output.txt");
+    ASSERT_EQ(expectedOutputFile.is_open(), true);
+    size_t numLabel = 0, cur = 0;
+    expectedOutputFile >> numLabel;
+    ASSERT_EQ(csr.label2idx.size(), numLabel);
+    for (const auto *mat : {&csr.stats.outCnt, &csr.stats.inCnt, &csr.stats.outCooccur, &csr.stats.inCooccur,
+    &csr.stats.tgtOutCnt, &csr.stats.tgtInCnt, &csr.stats.srcOutCnt, &csr.stats.srcInCnt}) {
+        for (size_t x = 0; x < numLabel; x++) {
+            for (size_t y = 0; y < numLabel; y++) {
+                expectedOutputFile >> cur;
+                EXPECT_EQ((*mat)[csr.label2idx[x]][csr.label2idx[y]], cur);
+            }
+        }
+    }
+    expectedOutputFile.close();
+
+    string statsFilePath = "StatisticsTestSuite_SimpleTest.stats";
+    ASSERT_EQ(csr.saveStats(statsFilePath), true);
+    MultiLabelCSR csrLoaded;
+    csrLoaded.loadGraph(dataDir + "SimpleTest_graph.txt");
+    ASSERT_EQ(csrLoaded.loadStats(statsFilePath), true);
+    EXPECT_EQ(csrLoaded.stats.outCnt, csr.stats.outCnt);
+    EXPECT_EQ(csrLoaded.stats.inCnt, csr.stats.inCnt);
+    EXPECT_EQ(csrLoaded.stats.outCooccur, csr.stats.outCooccur);
+    EXPECT_EQ(csrLoaded.stats.inCooccur, csr.stats.inCooccur);
+    EXPECT_EQ(csrLoaded.stats.tgtOutCnt, csr.stats.tgtOutCnt);
+    EXPECT_EQ(csrLoaded.stats.tgtInCnt, csr.stats.tgtInCnt);
+    EXPECT_EQ(csrLoaded.stats.srcOutCnt, csr.stats.srcOutCnt);
+    EXPECT_EQ(csrLoaded.stats.srcInCnt, csr.stats.srcInCnt);
+    remove(statsFilePath.c_str());
+}
+
+TEST(StatisticsTestSuite, StaleStatsTest) {
+    // Stats saved for a graph are refilled once the graph changes, even if its labels stay the same
+    string dataDir = "../test_data/StatisticsTestSuite/";
+    string graphFilePath = "StatisticsTestSuite_StaleStatsTest_graph.txt", statsFilePath = graphFilePath + ".stats";
+    {
+        std::ifstream fin(dataDir + "SimpleTest_graph.txt");
+        std::ofstream fout(graphFilePath);
+        ASSERT_EQ(fout.is_open(), true);
+        fout << fin.rdbuf();
+    }
+    MultiLabelCSR csr;
+    csr.loadGraph(graphFilePath);
+    csr.loadOrFillStats(statsFilePath);
+    MultiLabelCSR csrSame;
+    csrSame.loadGraph(graphFilePath);
+    EXPECT_EQ(csrSame.loadStats(statsFilePath), true);
+    {
+        std::ofstream fout(graphFilePath, std::ios::app);
+        fout << "5 1 1\n";
+    }
+    MultiLabelCSR csrChanged;
+    csrChanged.loadGraph(graphFilePath);
+    ASSERT_EQ(csrChanged.label2idx, csr.label2idx);
+    EXPECT_EQ(csrChanged.loadStats(statsFilePath), false);
+    csrChanged.loadOrFillStats(statsFilePath);
+    MultiLabelCSR csrFilled;
+    csrFilled.loadGraph(graphFilePath);
+    csrFilled.fillStats();
+    EXPECT_EQ(csrChanged.stats.outCnt, csrFilled.stats.outCnt);
+    EXPECT_NE(csrChanged.stats.outCnt, csr.stats.outCnt);
+    EXPECT_EQ(csrFilled.loadStats(statsFilePath), true);   // Saved again for the changed graph
+    remove(graphFilePath.c_str());
+    remove(statsFilePath.c_str());
+}
+
+TEST(EstimateCacheTestSuite, ReplanTest) {
+    std::shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
+    csrPtr->loadGraph("../test_data/ExecuteTestSuite/graph.txt");
+    AndOrDag aod(csrPtr);
+    for (const auto &q : vector<string>({"<1>/<2>/<3>", "(<1>/<2>)+/<3>", "(<1>|<2>)*/<3>"}))
+        aod.addWorkloadQuery(q, 1);
+    aod.initAuxiliary();
+    aod.annotateLeafCostCard();
+    aod.plan();
+    size_t numMiss = aod.getEstimateCacheMiss(), numHit = aod.getEstimateCacheHit();
+    EXPECT_GT(numMiss, 0);
+    // Replanning only revisits estimates computed by plan
+    ReplanWorkspace ws;
+    ReplanResult res;
+    for (size_t i = 0; i < aod.getNumNodes(); i++) {
+        if (aod.getNodes()[i].getIsEq() && !aod.getNodes()[i].getChildIdx().empty())
+            aod.replan({i}, ws, res);
+    }
+    EXPECT_EQ(aod.getEstimateCacheMiss(), numMiss);
+    EXPECT_GT(aod.getEstimateCacheHit(), numHit);
+}
+
+TEST(AutomatonCacheTestSuite, SharingTest) {
+    // Equivalent spellings share one compiled automaton; each kind is cached separately
+    AutomatonCache &cache = AutomatonCache::instance();
+    cache.clear();
+    shared_ptr<const NFA> nfaPtr = cache.get("<1>/<2>|<3>/<2>");
+    EXPECT_EQ(cache.get("(<3>/<2>)|((<1>)/<2>)"), nfaPtr);
+    EXPECT_NE(cache.get("<1>/<2>|<3>/<2>", AutomatonCache::DFA), nfaPtr);
+    EXPECT_EQ(cache.getNumHits(), 1);
+    EXPECT_EQ(cache.getNumMisses(), 2);
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(nfaPtr->states.size(), 5);
+
+    // Minimized: both <2> positions, and both positions before them, are merged
+    cache.clear();
+    cache.setMinimize(true);
+    shared_ptr<const NFA> minPtr = cache.get("<1>/<2>|<3>/<2>");
+    cache.setMinimize(false);
+    EXPECT_EQ(minPtr->states.size(), 3);
+    EXPECT_FALSE(minPtr->initial->accept);
+    EXPECT_TRUE(minPtr->sameNonEmptyLanguage(*nfaPtr));
+    for (const string q : {"(<1>*)*", "((<1>?)/(<2>?))+", "(<1>|<2>/<3>)*/<2>", "(<1>+|<2>?)/(<3>/<1>)+"}) {
+        Rpq2NFAConvertor cvrt;
+        shared_ptr<NFA> gPtr = cvrt.convertGlushkov(q);
+        shared_ptr<NFA> mPtr = gPtr->minimize();
+        EXPECT_LE(mPtr->states.size(), gPtr->states.size()) << q;
+        EXPECT_EQ(mPtr->initial->accept, gPtr->initial->accept) << q;
+        EXPECT_TRUE(mPtr->sameNonEmptyLanguage(*gPtr)) << q;
+    }
+
+    // Bounded: the least recently used entries are evicted
+    cache.clear();
+    cache.get("<1>/<2>");
+    size_t bytes = cache.getNumBytes();
+    cache.get("<2>/<3>");
+    EXPECT_EQ(cache.getNumBytes(), 2 * bytes);
+    cache.get("<1>/<2>");
+    cache.setMaxBytes(bytes);
+    EXPECT_EQ(cache.getNumEvictions(), 1);
+    EXPECT_EQ(cache.size(), 1);
+    cache.get("<1>/<2>");
+    EXPECT_EQ(cache.getNumHits(), 2);
+    cache.get("<3>/<1>");
+    EXPECT_EQ(cache.getNumEvictions(), 2);
+    EXPECT_LE(cache.getNumBytes(), bytes);
+    cache.setMaxBytes(0);
+    cache.clear();
+}
+
 std::vector<std::string> executeTestNames({"SingleIriTest", "SingleInverseIriTest", "AlternationTest", "ConcatTest",
 "ConcatKleeneTest", "KleeneIriConcatTest", "KleeneStarIriConcatTest", "IriKleeneStarConcat"});
 std::vector<std::pair<std::string, bool>> genExecuteTestNamesWithMode() {
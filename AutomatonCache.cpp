@@ -0,0 +1,113 @@
+/**
+ * @file AutomatonCache.cpp
+ * @brief Implements methods in AutomatonCache.h
+ * @date 2024-04-16
+ */
+
+#include "AutomatonCache.h"
+#include "Rpq2NFAConvertor.h"
+using namespace std;
+
+AutomatonCache &AutomatonCache::instance() {
+    static AutomatonCache ret;
+    return ret;
+}
+
+// Estimated heap footprint of the states and transitions
+size_t AutomatonCache::approxBytes(const NFA &nfa) {
+    size_t ret = sizeof(NFA) + nfa.states.capacity() * sizeof(std::shared_ptr<State>);
+    for (const auto &st : nfa.states)
+        ret += sizeof(State) + 2 * sizeof(void *) + st->outEdges.capacity() * sizeof(Transition);
+    return ret;
+}
+
+std::shared_ptr<const NFA> AutomatonCache::get(const std::string &q, Kind kind) {
+    string key = char(kind) + RpqAst::normalize(q);
+    {
+        lock_guard<mutex> lock(mtx);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            numHits++;
+            lru.splice(lru.begin(), lru, it->second.lruIt);
+            return it->second.nfaPtr;
+        }
+        numMisses++;
+    }
+    // Compile without holding the lock; if another thread cached the same query meanwhile, keep its automaton
+    Rpq2NFAConvertor cvrt;
+    shared_ptr<NFA> nfaPtr = kind == GLUSHKOV ? cvrt.convertGlushkov(key.substr(1)) : cvrt.convert(key.substr(1))->convert2Dfa();
+    bool minimize_ = false;
+    {
+        lock_guard<mutex> lock(mtx);
+        minimize_ = minimizeAutomata;
+    }
+    if (minimize_)
+        nfaPtr = nfaPtr->minimize();
+    size_t bytes = approxBytes(*nfaPtr) + key.capacity();
+    lock_guard<mutex> lock(mtx);
+    auto it = cache.find(key);
+    if (it != cache.end())
+        return it->second.nfaPtr;
+    if (maxBytes != 0 && bytes > maxBytes)
+        return nfaPtr;  // Never fits
+    evict(maxBytes == 0 ? SIZE_MAX : maxBytes - bytes);
+    lru.emplace_front(key);
+    cache.emplace(key, Entry{nfaPtr, bytes, lru.begin()});
+    numBytes += bytes;
+    return nfaPtr;
+}
+
+// Evict the least recently used entries until at most targetBytes are cached; the caller holds the lock
+void AutomatonCache::evict(size_t targetBytes) {
+    while (numBytes > targetBytes && !lru.empty()) {
+        auto it = cache.find(lru.back());
+        numBytes -= it->second.bytes;
+        cache.erase(it);
+        lru.pop_back();
+        numEvictions++;
+    }
+}
+
+void AutomatonCache::setMaxBytes(size_t maxBytes_) {
+    lock_guard<mutex> lock(mtx);
+    maxBytes = maxBytes_;
+    if (maxBytes != 0)
+        evict(maxBytes);
+}
+
+void AutomatonCache::setMinimize(bool minimize_) {
+    lock_guard<mutex> lock(mtx);
+    minimizeAutomata = minimize_;
+}
+
+void AutomatonCache::clear() {
+    lock_guard<mutex> lock(mtx);
+    cache.clear();
+    lru.clear();
+    numBytes = numHits = numMisses = numEvictions = 0;
+}
+
+size_t AutomatonCache::size() const {
+    lock_guard<mutex> lock(mtx);
+    return cache.size();
+}
+
+size_t AutomatonCache::getNumBytes() const {
+    lock_guard<mutex> lock(mtx);
+    return numBytes;
+}
+
+size_t AutomatonCache::getNumHits() const {
+    lock_guard<mutex> lock(mtx);
+    return numHits;
+}
+
+size_t AutomatonCache::getNumMisses() const {
+    lock_guard<mutex> lock(mtx);
+    return numMisses;
+}
+
+size_t AutomatonCache::getNumEvictions() const {
+    lock_guard<mutex> lock(mtx);
+    return numEvictions;
+}
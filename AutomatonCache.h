@@ -0,0 +1,53 @@
+/**
+ * @file AutomatonCache.h
+ * @brief Process-wide cache of the automata compiled from queries
+ * @date 2024-04-16
+ */
+
+#pragma once
+#include "NFA.h"
+#include <list>
+#include <mutex>
+
+/**
+ * @brief Compiles each query once per process: the DAG (cost estimation and view matching), the ad-hoc executor
+ * and the tools share the automaton of a query, keyed by its normalized text, so equivalent spellings share one
+ * entry too. Automata are optionally minimized before they are cached. With a byte bound, the least recently used
+ * entries are evicted to stay under it. Thread-safe. The automata are handed out const, so they run only with the
+ * const engines (e.g., executeBitParallel or executeLazyDfa, not execute, which keeps visited rows of
+ * #states x #vertices in the automaton); a cached automaton thus holds no more than approxBytes counts.
+ */
+class AutomatonCache {
+public:
+    enum Kind : char { GLUSHKOV = 'g', DFA = 'd' };   // convertGlushkov, or convert followed by convert2Dfa
+private:
+    struct Entry {
+        std::shared_ptr<const NFA> nfaPtr;
+        size_t bytes;
+        std::list<std::string>::iterator lruIt;
+    };
+    std::unordered_map<std::string, Entry> cache;   // Key: kind followed by the normalized query
+    std::list<std::string> lru; // Keys, most recently used first
+    size_t maxBytes;    // 0: unbounded
+    bool minimizeAutomata;
+    size_t numBytes, numHits, numMisses, numEvictions;
+    mutable std::mutex mtx;
+
+    AutomatonCache(): maxBytes(0), minimizeAutomata(false), numBytes(0), numHits(0), numMisses(0), numEvictions(0) {}
+    void evict(size_t targetBytes);
+public:
+    AutomatonCache(const AutomatonCache &) = delete;
+    AutomatonCache &operator=(const AutomatonCache &) = delete;
+    static AutomatonCache &instance();
+    static size_t approxBytes(const NFA &nfa);
+
+    std::shared_ptr<const NFA> get(const std::string &q, Kind kind=GLUSHKOV);    // Throws std::runtime_error on syntax errors
+    void setMaxBytes(size_t maxBytes_);
+    void setMinimize(bool minimize_);   // Applies to the automata compiled from now on
+    void clear();   // Drop all entries and reset the statistics
+    size_t size() const;
+    size_t getNumBytes() const;
+    size_t getNumHits() const;
+    size_t getNumMisses() const;
+    size_t getNumEvictions() const;
+};
@@ -72,6 +72,7 @@ void MultiLabelCSR::loadGraph(const std::string &filePath, LineSeq lineSeq) {
         }
         if (curNode != int(te.s)) {
             v2idxPtr->emplace(te.s, offsetVecPtr->size());
+            this->outCsr[curLabel].idx2v.emplace_back(te.s);
             offsetVecPtr->emplace_back(adjVecPtr->size());
             curNode = te.s;
         }
@@ -104,6 +105,7 @@ void MultiLabelCSR::loadGraph(const std::string &filePath, LineSeq lineSeq) {
         }
         if (curNode != int(te.t)) {
             v2idxPtr->emplace(te.t, offsetVecPtr->size());
+            this->inCsr[curLabel].idx2v.emplace_back(te.t);
             offsetVecPtr->emplace_back(adjVecPtr->size());
             curNode = te.t;
         }
@@ -113,6 +115,151 @@ void MultiLabelCSR::loadGraph(const std::string &filePath, LineSeq lineSeq) {
     this->inCsr[curLabel].n = offsetVecPtr->size();
 }
 
+/**
+ * @brief Fill stats in one pass over the edges of each label, labels in parallel.
+ * Each vertex's out/in label lists are collected first, so every edge only visits the labels of its endpoints.
+ */
+void MultiLabelCSR::fillStats() {
+    size_t numLabel = outCsr.size(), gN = size_t(maxNode) + 1;
+    // Per-vertex label lists in CSR form
+    vector<size_t> outLblOffset(gN + 1, 0), inLblOffset(gN + 1, 0);
+    for (size_t y = 0; y < numLabel; y++) {
+        for (unsigned v : outCsr[y].idx2v)
+            outLblOffset[v + 1]++;
+        for (unsigned v : inCsr[y].idx2v)
+            inLblOffset[v + 1]++;
+    }
+    for (size_t v = 0; v < gN; v++) {
+        outLblOffset[v + 1] += outLblOffset[v];
+        inLblOffset[v + 1] += inLblOffset[v];
+    }
+    vector<unsigned> outLbl(outLblOffset[gN]), inLbl(inLblOffset[gN]);
+    vector<size_t> outPos(outLblOffset.begin(), outLblOffset.end() - 1), inPos(inLblOffset.begin(), inLblOffset.end() - 1);
+    for (size_t y = 0; y < numLabel; y++) {
+        for (unsigned v : outCsr[y].idx2v)
+            outLbl[outPos[v]++] = y;
+        for (unsigned v : inCsr[y].idx2v)
+            inLbl[inPos[v]++] = y;
+    }
+
+    stats.outCnt.assign(numLabel, vector<size_t>(numLabel, 0));
+    stats.inCnt.assign(numLabel, vector<size_t>(numLabel, 0));
+    stats.outCooccur.assign(numLabel, vector<size_t>(numLabel, 0));
+    stats.inCooccur.assign(numLabel, vector<size_t>(numLabel, 0));
+    for (auto *mat : {&stats.tgtOutCnt, &stats.tgtInCnt, &stats.srcOutCnt, &stats.srcInCnt})
+        mat->assign(numLabel, vector<size_t>(numLabel, 0));
+    // Each label only writes its own rows
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t x = 0; x < numLabel; x++) {
+        // Out: per source, its other out labels (cooccur) and the out labels of its targets (next hop)
+        const MappedCSR &out = outCsr[x];
+        for (size_t i = 0; i < out.n; i++) {
+            unsigned s = out.idx2v[i];
+            size_t adjStart = out.offset[i], adjEnd = i < out.n - 1 ? out.offset[i + 1] : out.adj.size();
+            for (size_t j = outLblOffset[s]; j < outLblOffset[s + 1]; j++)
+                stats.srcOutCnt[x][outLbl[j]]++;
+            for (size_t j = inLblOffset[s]; j < inLblOffset[s + 1]; j++)
+                stats.srcInCnt[x][inLbl[j]]++;
+            for (size_t j = outLblOffset[s]; j < outLblOffset[s + 1]; j++)
+                stats.outCooccur[x][outLbl[j]] += adjEnd - adjStart;
+            for (size_t k = adjStart; k < adjEnd; k++) {
+                unsigned t = out.adj[k];
+                for (size_t j = outLblOffset[t]; j < outLblOffset[t + 1]; j++)
+                    stats.outCnt[x][outLbl[j]]++;
+            }
+        }
+        // In: symmetric, per target
+        const MappedCSR &in = inCsr[x];
+        for (size_t i = 0; i < in.n; i++) {
+            unsigned t = in.idx2v[i];
+            size_t adjStart = in.offset[i], adjEnd = i < in.n - 1 ? in.offset[i + 1] : in.adj.size();
+            for (size_t j = outLblOffset[t]; j < outLblOffset[t + 1]; j++)
+                stats.tgtOutCnt[x][outLbl[j]]++;
+            for (size_t j = inLblOffset[t]; j < inLblOffset[t + 1]; j++)
+                stats.tgtInCnt[x][inLbl[j]]++;
+            for (size_t j = inLblOffset[t]; j < inLblOffset[t + 1]; j++)
+                stats.inCooccur[x][inLbl[j]] += adjEnd - adjStart;
+            for (size_t k = adjStart; k < adjEnd; k++) {
+                unsigned s = in.adj[k];
+                for (size_t j = inLblOffset[s]; j < inLblOffset[s + 1]; j++)
+                    stats.inCnt[x][inLbl[j]]++;
+            }
+        }
+    }
+}
+
+// Stats file format: #labels, the labels in label index order, per label its #edges, #sources and #targets (to tell
+// a changed graph with the same labels), then outCnt, inCnt, outCooccur, inCooccur, tgtOutCnt, tgtInCnt, srcOutCnt,
+// srcInCnt row by row
+bool MultiLabelCSR::saveStats(const std::string &filePath) const {
+    if (stats.empty())
+        return false;
+    ofstream fout(filePath);
+    if (!fout.is_open())
+        return false;
+    size_t numLabel = label2idx.size();
+    vector<double> idx2label(numLabel);
+    for (const auto &pr : label2idx)
+        idx2label[pr.second] = pr.first;
+    fout << numLabel << '\n';
+    for (size_t x = 0; x < numLabel; x++)
+        fout << size_t(idx2label[x]) << (x == numLabel - 1 ? '\n' : ' ');
+    for (size_t x = 0; x < numLabel; x++)
+        fout << outCsr[x].m << ' ' << outCsr[x].n << ' ' << inCsr[x].n << '\n';
+    for (const auto *mat : {&stats.outCnt, &stats.inCnt, &stats.outCooccur, &stats.inCooccur, &stats.tgtOutCnt,
+    &stats.tgtInCnt, &stats.srcOutCnt, &stats.srcInCnt}) {
+        for (size_t x = 0; x < numLabel; x++)
+            for (size_t y = 0; y < numLabel; y++)
+                fout << (*mat)[x][y] << (y == numLabel - 1 ? '\n' : ' ');
+    }
+    return true;
+}
+
+// Fails (leaving stats unchanged) if the file is missing, or was saved for a different label mapping or different
+// per-label edge and vertex counts
+bool MultiLabelCSR::loadStats(const std::string &filePath) {
+    ifstream fin(filePath);
+    if (!fin.is_open())
+        return false;
+    size_t numLabel = 0;
+    fin >> numLabel;
+    if (numLabel != label2idx.size())
+        return false;
+    double lbl = 0;
+    for (size_t x = 0; x < numLabel; x++) {
+        fin >> lbl;
+        auto it = label2idx.find(lbl);
+        if (!fin || it == label2idx.end() || it->second != x)
+            return false;
+    }
+    size_t numEdges = 0, numSrcs = 0, numTgts = 0;
+    for (size_t x = 0; x < numLabel; x++) {
+        fin >> numEdges >> numSrcs >> numTgts;
+        if (!fin || numEdges != outCsr[x].m || numSrcs != outCsr[x].n || numTgts != inCsr[x].n)
+            return false;
+    }
+    Statistics tmpStats;
+    for (auto *mat : {&tmpStats.outCnt, &tmpStats.inCnt, &tmpStats.outCooccur, &tmpStats.inCooccur, &tmpStats.tgtOutCnt,
+    &tmpStats.tgtInCnt, &tmpStats.srcOutCnt, &tmpStats.srcInCnt}) {
+        mat->assign(numLabel, vector<size_t>(numLabel, 0));
+        for (size_t x = 0; x < numLabel; x++)
+            for (size_t y = 0; y < numLabel; y++)
+                fin >> (*mat)[x][y];
+    }
+    if (!fin)
+        return false;
+    stats = std::move(tmpStats);
+    return true;
+}
+
+void MultiLabelCSR::loadOrFillStats(const std::string &filePath) {
+    if (loadStats(filePath))
+        return;
+    fillStats();
+    if (!saveStats(filePath))
+        cerr << "Cannot save stats to " << filePath << endl;
+}
+
 // v is the vertex ID in the original graph before mapping
 void MappedCSR::getAdjIntervalByVert(unsigned v, AdjInterval &aitv) const {
     auto iter = v2idx.find(v);
@@ -157,6 +304,39 @@ bool MappedCSR::operator == (const MappedCSR &c) const {
     return true;
 }
 
+/**
+ * @brief Set this to the pairs of c flipped, in O(n + m): count the pairs of each target, lay out the rows of the
+ * targets in the order they are first met, then place each pair at its row's next free slot.
+ */
+void MappedCSR::assignAsTranspose(const MappedCSR &c) {
+    vector<unsigned> rowV(c.n);
+    for (const auto &pr : c.v2idx)
+        rowV[pr.second] = pr.first;
+    v2idx.clear();
+    offset.clear();
+    for (size_t i = 0; i < c.m; i++) {
+        auto ins = v2idx.emplace(c.adj[i], offset.size());
+        if (ins.second)
+            offset.emplace_back(0);
+        offset[ins.first->second]++;
+    }
+    n = offset.size();
+    m = c.m;
+    unsigned sum = 0;
+    for (auto &off : offset) {
+        unsigned cnt = off;
+        off = sum;
+        sum += cnt;
+    }
+    vector<unsigned> nextPos(offset);
+    adj.assign(m, 0);
+    for (size_t idx = 0; idx < c.n; idx++) {
+        size_t rowEnd = idx == c.n - 1 ? c.m : c.offset[idx + 1];
+        for (size_t i = c.offset[idx]; i < rowEnd; i++)
+            adj[nextPos[v2idx[c.adj[i]]]++] = rowV[idx];
+    }
+}
+
 // Union the results in the list to get new result
 void QueryResult::assignAsUnion(const std::vector<QueryResult> &qrList) {
     this->tryNew();
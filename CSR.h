@@ -31,6 +31,7 @@ struct MappedCSR {
     std::vector<unsigned> adj;
     std::vector<unsigned> offset;
     std::unordered_map<unsigned, unsigned> v2idx;
+    std::vector<unsigned> idx2v;    // Inverse of v2idx for random access to vertices (filled for graph CSRs only)
     MappedCSR(): n(0), m(0) {}
     void getAdjIntervalByVert(unsigned v, AdjInterval &aitv) const;
     bool empty() const { return v2idx.empty(); }
@@ -46,21 +47,31 @@ struct MappedCSR {
         std::cout << std::endl;
     }
     bool operator == (const MappedCSR &c) const;
+    void assignAsTranspose(const MappedCSR &c); // The pairs of c flipped, by counting instead of sorting
     bool operator != (const MappedCSR &c) const { return !(*this == c); }
 };
 
+// All matrices are indexed by label index (label2idx), not by the label in the file
 struct Statistics {
     std::vector<std::vector<size_t>> outCnt, inCnt; // outCnt[x][y]: #x-edges whose next hop has y-edges
-    // outCooccur[x][y]: #x-edges whose start nodes also have y-edges. Note: when x==y, the cooccur probability is always 1
+    // outCooccur[x][y]: #x-edges whose start nodes also have y-edges; outCooccur[x][x] is thus the #x-edges
     std::vector<std::vector<size_t>> outCooccur, inCooccur;
+    // Per distinct endpoint: tgtOutCnt[x][y]: #targets of x-edges with out y-edges (tgtIn: in y-edges; src: sources)
+    std::vector<std::vector<size_t>> tgtOutCnt, tgtInCnt, srcOutCnt, srcInCnt;
+    bool empty() const { return outCnt.empty(); }
 };
 
 struct MultiLabelCSR {
     std::vector<MappedCSR> outCsr, inCsr;
     std::unordered_map<double, size_t> label2idx;
     unsigned maxNode;   // The maximum node id
+    Statistics stats;   // Label-correlation summary, empty until fillStats or loadStats
     MultiLabelCSR(): maxNode(0) {}
     void loadGraph(const std::string &filePath, LineSeq lineSeq=sop);
+    void fillStats();
+    bool saveStats(const std::string &filePath) const;
+    bool loadStats(const std::string &filePath);
+    void loadOrFillStats(const std::string &filePath); // Load stats saved with the graph, or fill and save them
 };
 
 struct QueryResult {
@@ -7,7 +7,7 @@ int main() {
     string graphFilePath = dataDir + "graph.txt";
     shared_ptr<MultiLabelCSR> csrPtr = make_shared<MultiLabelCSR>();
     csrPtr->loadGraph(graphFilePath, spo);
-    // csrPtr->fillStats();
+    csrPtr->loadOrFillStats(graphFilePath + ".stats");
 
     string queryFilePath = dataDir + "queries.txt";
     unordered_map<string, size_t> querySet;
@@ -45,10 +45,36 @@ int main() {
             delete qr.csrPtr;
 
         start_time = std::chrono::steady_clock::now();
-        shared_ptr<NFA> dfaPtr = cvrt.convert(pr.first)->convert2Dfa();
-        shared_ptr<MappedCSR> res = dfaPtr->execute(csrPtr);
+        // execute keeps its visited rows in the automaton, so run a DFA of this query's own, freed after it
+        shared_ptr<MappedCSR> res = cvrt.convert(pr.first)->convert2Dfa()->executeCheaperDirection(csrPtr);
         end_time = std::chrono::steady_clock::now();
         elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
         std::cout << "DFA execution used: " << elapsed_microseconds.count() << " us" << std::endl;
+
+        start_time = std::chrono::steady_clock::now();
+        res = cvrt.convert(pr.first)->executeLazyDfa(csrPtr);
+        end_time = std::chrono::steady_clock::now();
+        elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+        std::cout << "Lazy DFA execution used: " << elapsed_microseconds.count() << " us" << std::endl;
+    }
+
+    // Batch mode: the queries of a batch share one traversal of the graph
+    const size_t BATCHSZ = 32;
+    vector<string> queries;
+    for (const auto &pr : querySet)
+        queries.emplace_back(pr.first);
+    for (size_t i = 0; i < queries.size(); i += BATCHSZ) {
+        size_t batchEnd = min(i + BATCHSZ, queries.size());
+        start_time = std::chrono::steady_clock::now();
+        vector<shared_ptr<NFA>> nfaPtrs;
+        vector<const NFA *> batch;
+        for (size_t j = i; j < batchEnd; j++) {
+            nfaPtrs.emplace_back(cvrt.convert(queries[j]));
+            batch.emplace_back(nfaPtrs.back().get());
+        }
+        vector<shared_ptr<MappedCSR>> res = NFA::executeBatch(batch, csrPtr);
+        end_time = std::chrono::steady_clock::now();
+        elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+        std::cout << "Batch DFA execution of " << batchEnd - i << " queries used: " << elapsed_microseconds.count() << " us" << std::endl;
     }
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
  */
 
 #include "NFA.h"
+#include <map>
+#include <tuple>
 
 using namespace std;
 
@@ -304,8 +306,178 @@ void NFA::reverse() {
     initial = initialNew;
 }
 
+/**
+ * @brief Whether this and other accept the same nonempty words (whether they accept the empty word is ignored).
+ * Both must be free of eps transitions (e.g., returned by convert2Dfa), but may be nondeterministic: the subset
+ * automata of both are explored in lockstep, and a reachable pair of subsets differing in acceptance disproves it.
+ *
+ * @param maxPairs give up (returning false) after exploring this many pairs of subsets
+ */
+bool NFA::sameNonEmptyLanguage(const NFA &other, size_t maxPairs) const {
+    typedef vector<const State *> Subset;   // Sorted by address
+    auto anyAccept = [](const Subset &s) {
+        for (const State *st : s)
+            if (st->accept)
+                return true;
+        return false;
+    };
+    // Only the initial pair stands for the empty word, so its acceptance is not compared
+    set<pair<Subset, Subset>> seen;
+    vector<pair<Subset, Subset>> stk;
+    map<pair<int, bool>, pair<Subset, Subset>> next;
+    stk.emplace_back(Subset{initial.get()}, Subset{other.initial.get()});
+    bool isInitial = true;
+    while (!stk.empty()) {
+        auto cur = std::move(stk.back());
+        stk.pop_back();
+        if (!isInitial && anyAccept(cur.first) != anyAccept(cur.second))
+            return false;
+        isInitial = false;
+        next.clear();
+        for (const State *st : cur.first)
+            for (const auto &tr : st->outEdges)
+                next[make_pair(tr.lbl, tr.forward)].first.emplace_back(tr.dst.get());
+        for (const State *st : cur.second)
+            for (const auto &tr : st->outEdges)
+                next[make_pair(tr.lbl, tr.forward)].second.emplace_back(tr.dst.get());
+        for (auto &pr : next) {
+            for (Subset *s : {&pr.second.first, &pr.second.second}) {
+                sort(s->begin(), s->end());
+                s->erase(unique(s->begin(), s->end()), s->end());
+            }
+            // A label only one side can read leads the other side to the dead (empty) subset
+            if (seen.insert(pr.second).second) {
+                if (seen.size() > maxPairs)
+                    return false;
+                stk.emplace_back(std::move(pr.second));
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Unlike reverse, which adds a new initial state with eps transitions to the accept states, the new initial
+ * state takes the (reversed) transitions into the accept states directly, so the result is eps-free too. Accepts the
+ * empty path iff this does.
+ */
+std::shared_ptr<NFA> NFA::reversed() const {
+    shared_ptr<NFA> ret = make_shared<NFA>();
+    ret->unsetAccept();
+    unordered_map<const State *, shared_ptr<State>> state2rev;
+    for (const auto &st : states)
+        state2rev[st.get()] = ret->addState(false);
+    ret->setAccept(state2rev[initial.get()]);
+    if (initial->accept)
+        ret->setAccept(ret->initial);
+    for (const auto &st : states) {
+        for (const auto &oe : st->outEdges) {
+            assert(oe.lbl != -1);
+            state2rev[oe.dst.get()]->addTransition(oe.lbl, !oe.forward, state2rev[st.get()]);
+            if (oe.dst->accept)
+                ret->initial->addTransition(oe.lbl, !oe.forward, state2rev[st.get()]);
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Estimate the cost of each direction by the number of vertices a traversal starts from: the vertices with
+ * a label the initial state reads (forward), or with a label read into an accept state, at its other end
+ * (backward), from the label cardinalities. An automaton accepting the empty path is always run forward, as its
+ * (s, s) pairs depend on the forward sources.
+ */
+bool NFA::cheaperBackward(const MultiLabelCSR &csr) const {
+    if (initial->accept)
+        return false;
+    auto numVerts = [&csr](int lbl, bool out) -> size_t {
+        auto it = csr.label2idx.find(lbl);
+        if (it == csr.label2idx.end())
+            return 0;
+        return out ? csr.outCsr[it->second].n : csr.inCsr[it->second].n;
+    };
+    set<pair<int, bool>> fwdLbls, bwdLbls;
+    for (const auto &oe : initial->outEdges)
+        fwdLbls.emplace(oe.lbl, oe.forward);
+    for (const auto &st : states)
+        for (const auto &oe : st->outEdges)
+            if (oe.dst->accept)
+                bwdLbls.emplace(oe.lbl, oe.forward);
+    size_t fwdCost = 0, bwdCost = 0;
+    for (const auto &pr : fwdLbls)
+        fwdCost += numVerts(pr.first, pr.second);
+    for (const auto &pr : bwdLbls)
+        bwdCost += numVerts(pr.first, !pr.second);
+    return bwdCost < fwdCost;
+}
+
+/**
+ * @brief Merge the states that cannot be told apart by their transitions: start from the accepting and the other
+ * states, and split blocks by the set of (label, direction, block of the destination) of their states until no block
+ * splits. Merging such (bisimilar) states keeps the language, eps transitions included; for a deterministic automaton
+ * without unreachable or dead states, this is Moore's minimization. The states of the result have sequential ids.
+ */
+std::shared_ptr<NFA> NFA::minimize() const {
+    size_t numStates = states.size();
+    unordered_map<const State *, size_t> state2idx;
+    for (size_t i = 0; i < numStates; i++)
+        state2idx[states[i].get()] = i;
+    vector<size_t> block(numStates), nextBlock(numStates);
+    for (size_t i = 0; i < numStates; i++)
+        block[i] = states[i]->accept ? 1 : 0;
+    size_t numBlocks = 0;
+    while (true) {
+        map<pair<size_t, vector<tuple<int, bool, size_t>>>, size_t> sig2block;
+        vector<tuple<int, bool, size_t>> sig;
+        for (size_t i = 0; i < numStates; i++) {
+            sig.clear();
+            for (const auto &oe : states[i]->outEdges)
+                sig.emplace_back(oe.lbl, oe.forward, block[state2idx[oe.dst.get()]]);
+            sort(sig.begin(), sig.end());
+            sig.erase(unique(sig.begin(), sig.end()), sig.end());
+            nextBlock[i] = sig2block.emplace(make_pair(block[i], sig), sig2block.size()).first->second;
+        }
+        // Blocks only split, so the partition is stable once their number stays the same
+        block.swap(nextBlock);
+        if (sig2block.size() == numBlocks)
+            break;
+        numBlocks = sig2block.size();
+    }
+
+    shared_ptr<NFA> ret = make_shared<NFA>();
+    ret->unsetAccept();
+    vector<shared_ptr<State>> blockState(numBlocks, nullptr);
+    blockState[block[state2idx[initial.get()]]] = ret->initial;
+    for (size_t i = 0; i < numStates; i++) {
+        auto &st = blockState[block[i]];
+        if (!st)
+            st = ret->addState(false);
+        if (states[i]->accept && !st->accept)
+            ret->setAccept(st);
+    }
+    // Bisimilar states have the same transitions between blocks, so one state per block suffices
+    vector<bool> done(numBlocks, false);
+    set<tuple<int, bool, size_t>> seen;
+    for (size_t i = 0; i < numStates; i++) {
+        if (done[block[i]])
+            continue;
+        done[block[i]] = true;
+        seen.clear();
+        for (const auto &oe : states[i]->outEdges) {
+            size_t dstBlock = block[state2idx[oe.dst.get()]];
+            if (seen.emplace(oe.lbl, oe.forward, dstBlock).second)
+                blockState[block[i]]->addTransition(oe.lbl, oe.forward, blockState[dstBlock]);
+        }
+    }
+    return ret;
+}
+
 // DFS execution, return true as soon as a result is found
 bool NFA::checkIfValidSrc(size_t dataNode, std::shared_ptr<const MultiLabelCSR> csrPtr, int curVisMark) {
+    return checkIfValidSrc(dataNode, *csrPtr, curVisMark, vis);
+}
+
+bool NFA::checkIfValidSrc(size_t dataNode, const MultiLabelCSR &csr, int curVisMark, int **curVis) const {
     stack<pair<unsigned, shared_ptr<State>>> st;
     shared_ptr<State> s0 = this->initial;
     unsigned v, nextV;
@@ -321,37 +493,37 @@ bool NFA::checkIfValidSrc(size_t dataNode, std::shared_ptr<const MultiLabelCSR>
         s = pr.second;
         // Early return true when the next state is accept
         for (const auto &oe : s->outEdges) {
-            it = csrPtr->label2idx.find(oe.lbl);
-            if (it == csrPtr->label2idx.end())
+            it = csr.label2idx.find(oe.lbl);
+            if (it == csr.label2idx.end())
                 continue;
             size_t curLblIdx = it->second;
             auto forward = oe.forward;
             auto dst = oe.dst;
             if (forward) {
-                csrPtr->outCsr[curLblIdx].getAdjIntervalByVert(v, aitv);
+                csr.outCsr[curLblIdx].getAdjIntervalByVert(v, aitv);
                 if (aitv.len > 0) {
                     if (this->isAccept(dst))
                         return true;
                     for (size_t j = 0; j < aitv.len; j++) {
                         nextV = (*aitv.start)[aitv.offset + j];
-                        if (vis[dst->id][nextV] != curVisMark) {
+                        if (curVis[dst->id][nextV] != curVisMark) {
                             // cout << v << ',' << nextV << ',' << dst->id << ' ';
                             st.emplace(nextV, dst);
-                            vis[dst->id][nextV] = curVisMark;
+                            curVis[dst->id][nextV] = curVisMark;
                         }
                     }
                 }
             } else {
-                csrPtr->inCsr[curLblIdx].getAdjIntervalByVert(v, aitv);
+                csr.inCsr[curLblIdx].getAdjIntervalByVert(v, aitv);
                 if (aitv.len > 0) {
                     if (this->isAccept(dst))
                         return true;
                     for (size_t j = 0; j < aitv.len; j++) {
                         nextV = (*aitv.start)[aitv.offset + j];
-                        if (vis[dst->id][nextV] != curVisMark) {
+                        if (curVis[dst->id][nextV] != curVisMark) {
                             // cout << v << ',' << nextV << ',' << dst->id << ' ';
                             st.emplace(nextV, dst);
-                            vis[dst->id][nextV] = curVisMark;
+                            curVis[dst->id][nextV] = curVisMark;
                         }
                     }
                 }
@@ -362,6 +534,10 @@ bool NFA::checkIfValidSrc(size_t dataNode, std::shared_ptr<const MultiLabelCSR>
 }
 
 std::shared_ptr<MappedCSR> NFA::execute(std::shared_ptr<const MultiLabelCSR> csrPtr) {
+    int closureLbl = 0;
+    bool closureForward = true;
+    if (isSingleLabelClosure(closureLbl, closureForward))
+        return executeClosure(*csrPtr, closureLbl, closureForward);
     queue<pair<unsigned, shared_ptr<State>>> q;
     shared_ptr<State> s0 = this->initial;
     unsigned v, nextV;
@@ -443,6 +619,569 @@ std::shared_ptr<MappedCSR> NFA::execute(std::shared_ptr<const MultiLabelCSR> csr
     return ret;
 }
 
+/**
+ * @brief Over a single (label, direction), a word of length k is accepted iff a state reached in exactly k steps
+ * accepts. So the automaton accepts every nonempty word iff all the states reached in one or more steps accept and
+ * can take another step; with the initial state accepting or not, it is lbl* or lbl+.
+ */
+bool NFA::isSingleLabelClosure(int &lbl, bool &forward) const {
+    if (initial->outEdges.empty())
+        return false;
+    lbl = initial->outEdges[0].lbl;
+    forward = initial->outEdges[0].forward;
+    if (lbl == -1)
+        return false;
+    unordered_set<const State *> reached;
+    vector<const State *> q;
+    for (const auto &oe : initial->outEdges)
+        if (reached.emplace(oe.dst.get()).second)
+            q.emplace_back(oe.dst.get());
+    for (size_t head = 0; head < q.size(); head++) {
+        const State *st = q[head];
+        if (!st->accept || st->outEdges.empty())
+            return false;
+        for (const auto &oe : st->outEdges)
+            if (reached.emplace(oe.dst.get()).second)
+                q.emplace_back(oe.dst.get());
+    }
+    // The initial state's transitions were checked only if it was reached again
+    for (const auto &oe : initial->outEdges)
+        if (oe.lbl != lbl || oe.forward != forward)
+            return false;
+    for (const State *st : q)
+        for (const auto &oe : st->outEdges)
+            if (oe.lbl != lbl || oe.forward != forward)
+                return false;
+    return true;
+}
+
+/**
+ * @brief Answer lbl+ (lbl* if the initial state accepts) from the same sources as execute, by a level-synchronous
+ * BFS per source with dense bitmaps for the frontier and the visited vertices. A level is expanded top-down (push
+ * over the CSR of the direction) or, once the frontier's edges exceed the unexplored edges / PULLALPHA, bottom-up:
+ * each unvisited vertex with an edge of the label (pull over the opposite CSR) checks whether a neighbor is in the
+ * frontier. The candidates of a source are listed at its first pull and shrink as they are visited, so a pull
+ * scans only the vertices still unvisited; the BFS pushes again once the frontier is smaller than them / PUSHBETA.
+ * Only the bits set for a source are cleared after it. As the BFS restarts per source, switching to pull pays off
+ * when a source reaches a large part of the graph; with many sources each reaching little, it mostly pushes.
+ */
+std::shared_ptr<MappedCSR> NFA::executeClosure(const MultiLabelCSR &csr, int lbl, bool forward) const {
+    shared_ptr<MappedCSR> ret = make_shared<MappedCSR>();
+    auto it = csr.label2idx.find(lbl);
+    if (it == csr.label2idx.end())
+        return ret;
+    const MappedCSR &pushCsr = forward ? csr.outCsr[it->second] : csr.inCsr[it->second];
+    const MappedCSR &pullCsr = forward ? csr.inCsr[it->second] : csr.outCsr[it->second];
+    bool reflexive = initial->accept;
+    size_t gN = csr.maxNode + 1, numWords = (gN + 63) / 64;
+    vector<uint64_t> visited(numWords, 0), frontierBits(numWords, 0);
+    auto testBit = [](const vector<uint64_t> &bits, unsigned v) { return (bits[v / 64] >> (v % 64)) & 1; };
+    auto setBit = [](vector<uint64_t> &bits, unsigned v) { bits[v / 64] |= uint64_t(1) << (v % 64); };
+    auto resetBit = [](vector<uint64_t> &bits, unsigned v) { bits[v / 64] &= ~(uint64_t(1) << (v % 64)); };
+    vector<unsigned> frontier, next, candidates, tmpAdj, tmpOffset;
+    AdjInterval aitv;
+    for (const auto &spr : pushCsr.v2idx) {
+        unsigned sNode = spr.first;
+        size_t prevSz = tmpAdj.size();
+        if (reflexive) {
+            setBit(visited, sNode);
+            tmpAdj.emplace_back(sNode);
+        }
+        frontier.assign(1, sNode);
+        pushCsr.getAdjIntervalByVert(sNode, aitv);
+        size_t unexploredEdges = pushCsr.m - aitv.len;  // The source's edges are explored by the first level
+        bool pull = false, listed = false;
+        while (!frontier.empty()) {
+            size_t frontierEdges = 0;
+            for (unsigned v : frontier) {
+                pushCsr.getAdjIntervalByVert(v, aitv);
+                frontierEdges += aitv.len;
+            }
+            if (!pull && frontierEdges > unexploredEdges / PULLALPHA)
+                pull = true;
+            else if (pull && frontier.size() < candidates.size() / PUSHBETA)
+                pull = false;
+            next.clear();
+            if (!pull) {
+                for (unsigned v : frontier) {
+                    pushCsr.getAdjIntervalByVert(v, aitv);
+                    for (size_t j = 0; j < aitv.len; j++) {
+                        unsigned u = (*aitv.start)[aitv.offset + j];
+                        if (!testBit(visited, u)) {
+                            setBit(visited, u);
+                            next.emplace_back(u);
+                        }
+                    }
+                }
+            } else {
+                if (!listed) {
+                    candidates.assign(pullCsr.idx2v.begin(), pullCsr.idx2v.end());
+                    listed = true;
+                }
+                for (unsigned v : frontier)
+                    setBit(frontierBits, v);
+                // Keep the candidates still unvisited after this level (some may have been visited by pushes)
+                size_t numLeft = 0;
+                for (unsigned u : candidates) {
+                    if (testBit(visited, u))
+                        continue;
+                    bool found = false;
+                    pullCsr.getAdjIntervalByVert(u, aitv);
+                    for (size_t j = 0; j < aitv.len && !found; j++)
+                        found = testBit(frontierBits, (*aitv.start)[aitv.offset + j]);
+                    if (found) {
+                        setBit(visited, u);
+                        next.emplace_back(u);
+                    } else
+                        candidates[numLeft++] = u;
+                }
+                candidates.resize(numLeft);
+                for (unsigned v : frontier)
+                    resetBit(frontierBits, v);
+            }
+            for (unsigned u : next) {
+                pushCsr.getAdjIntervalByVert(u, aitv);
+                unexploredEdges -= min(unexploredEdges, aitv.len);
+                tmpAdj.emplace_back(u);
+            }
+            frontier.swap(next);
+        }
+        for (size_t j = prevSz; j < tmpAdj.size(); j++)
+            resetBit(visited, tmpAdj[j]);
+        if (tmpAdj.size() > prevSz) {
+            ret->v2idx[sNode] = tmpOffset.size();
+            tmpOffset.emplace_back(prevSz);
+        }
+    }
+    ret->n = tmpOffset.size();
+    ret->offset = move(tmpOffset);
+    ret->m = tmpAdj.size();
+    ret->adj = move(tmpAdj);
+    return ret;
+}
+
+// The backward pairs are flipped back by counting, without sorting them again
+std::shared_ptr<MappedCSR> NFA::executeCheaperDirection(std::shared_ptr<const MultiLabelCSR> csrPtr) {
+    if (!cheaperBackward(*csrPtr))
+        return execute(csrPtr);
+    shared_ptr<MappedCSR> bwdRes = reversed()->execute(csrPtr), ret = make_shared<MappedCSR>();
+    ret->assignAsTranspose(*bwdRes);
+    return ret;
+}
+
+/**
+ * @brief Simulate the NFA from each source with a set of states per data vertex instead of a visited row per
+ * state: a vertex keeps, as a bitmask (one word per 64 states), the states it is reached in, and is expanded
+ * again only with the states it newly gains. A step reads one (label, direction) for all states of the vertex
+ * at once, from precomputed successor masks, so there is no cap on the number of states (nor determinization).
+ * Masks are kept only for the vertices visited from the current source, and the states yet to expand only for
+ * those in the worklist; every data vertex costs just an index. The NFA must be free of eps transitions (e.g.,
+ * from convertGlushkov or convert2Dfa); the sources and results are the same as execute's.
+ */
+std::shared_ptr<MappedCSR> NFA::executeBitParallel(std::shared_ptr<const MultiLabelCSR> csrPtr) const {
+    const MultiLabelCSR &csr = *csrPtr;
+    size_t numStates = states.size(), W = (numStates + 63) / 64;
+    unordered_map<const State *, size_t> state2idx;
+    for (size_t i = 0; i < numStates; i++)
+        state2idx[states[i].get()] = i;
+    // Per (label, direction) read by some transition: the adjacency to follow, the states reading it, and the
+    // successors of each state by it
+    struct Step {
+        const MappedCSR *lblCsrPtr;
+        vector<uint64_t> from, succ;
+    };
+    vector<Step> steps;
+    map<pair<int, bool>, size_t> step2idx;
+    vector<uint64_t> acceptMask(W, 0), initMask(W, 0);
+    for (size_t i = 0; i < numStates; i++) {
+        if (states[i]->accept)
+            acceptMask[i / 64] |= uint64_t(1) << (i % 64);
+        for (const auto &oe : states[i]->outEdges) {
+            assert(oe.lbl != -1);
+            auto it = csr.label2idx.find(oe.lbl);
+            if (it == csr.label2idx.end())
+                continue;
+            auto stepIt = step2idx.find(make_pair(oe.lbl, oe.forward));
+            if (stepIt == step2idx.end()) {
+                stepIt = step2idx.emplace(make_pair(oe.lbl, oe.forward), steps.size()).first;
+                steps.push_back({oe.forward ? &csr.outCsr[it->second] : &csr.inCsr[it->second],
+                    vector<uint64_t>(W, 0), vector<uint64_t>(numStates * W, 0)});
+            }
+            Step &step = steps[stepIt->second];
+            size_t j = state2idx[oe.dst.get()];
+            step.from[i / 64] |= uint64_t(1) << (i % 64);
+            step.succ[i * W + j / 64] |= uint64_t(1) << (j % 64);
+        }
+    }
+    size_t s0 = state2idx[initial.get()];
+    initMask[s0 / 64] |= uint64_t(1) << (s0 % 64);
+
+    // Only the vertices visited from the current source get a slot: their state mask, whether they are accepted,
+    // and the worklist entry holding their states not yet expanded (if any)
+    const unsigned NO_SLOT = numeric_limits<unsigned>::max();
+    const size_t NOT_PENDING = numeric_limits<size_t>::max();
+    size_t gN = csr.maxNode + 1;
+    vector<unsigned> slotOf(gN, NO_SLOT), visited, frontier, tmpAdj, tmpOffset;
+    vector<uint64_t> masks, pend, d(W), next(W), gain(W);  // W words per slot / per worklist entry
+    vector<size_t> pendOf;
+    vector<bool> accepted;
+    auto addSlot = [&](unsigned v) {
+        slotOf[v] = visited.size();
+        visited.emplace_back(v);
+        masks.insert(masks.end(), W, 0);
+        pendOf.emplace_back(NOT_PENDING);
+        accepted.push_back(false);
+        return slotOf[v];
+    };
+    unordered_set<unsigned> src;
+    shared_ptr<MappedCSR> ret = make_shared<MappedCSR>();
+    AdjInterval aitv;
+    for (const auto &initOut : initial->outEdges) {
+        auto it = csr.label2idx.find(initOut.lbl);
+        if (it == csr.label2idx.end())
+            continue;
+        const auto &v2idx = initOut.forward ? csr.outCsr[it->second].v2idx : csr.inCsr[it->second].v2idx;
+        for (const auto &spr : v2idx) {
+            unsigned sNode = spr.first;
+            if (!src.emplace(sNode).second)
+                continue;
+            size_t prevSz = tmpAdj.size();
+            unsigned s = addSlot(sNode);
+            copy(initMask.begin(), initMask.end(), masks.begin() + s * W);
+            pendOf[s] = 0;
+            frontier.emplace_back(sNode);
+            pend.insert(pend.end(), initMask.begin(), initMask.end());
+            if (initial->accept) {
+                accepted[s] = true;
+                tmpAdj.emplace_back(sNode);
+            }
+            for (size_t head = 0; head < frontier.size(); head++) {
+                unsigned v = frontier[head];
+                pendOf[slotOf[v]] = NOT_PENDING;
+                copy(pend.begin() + head * W, pend.begin() + (head + 1) * W, d.begin());
+                for (const auto &step : steps) {
+                    // States reached from the new states of v by the step
+                    fill(next.begin(), next.end(), 0);
+                    bool any = false;
+                    for (size_t w = 0; w < W; w++) {
+                        for (uint64_t bits = d[w] & step.from[w]; bits; bits &= bits - 1) {
+                            size_t p = w * 64 + __builtin_ctzll(bits);
+                            for (size_t x = 0; x < W; x++)
+                                next[x] |= step.succ[p * W + x];
+                            any = true;
+                        }
+                    }
+                    if (!any)
+                        continue;
+                    step.lblCsrPtr->getAdjIntervalByVert(v, aitv);
+                    for (size_t j = 0; j < aitv.len; j++) {
+                        unsigned u = (*aitv.start)[aitv.offset + j];
+                        unsigned su = slotOf[u];
+                        if (su == NO_SLOT)
+                            su = addSlot(u);
+                        uint64_t *mu = &masks[su * W];
+                        bool gained = false;
+                        for (size_t x = 0; x < W; x++) {
+                            gain[x] = next[x] & ~mu[x];
+                            gained = gained || gain[x];
+                        }
+                        if (!gained)
+                            continue;
+                        if (pendOf[su] == NOT_PENDING) {
+                            pendOf[su] = frontier.size();
+                            frontier.emplace_back(u);
+                            pend.insert(pend.end(), W, 0);
+                        }
+                        uint64_t *du = &pend[pendOf[su] * W];
+                        bool newAccept = false;
+                        for (size_t x = 0; x < W; x++) {
+                            mu[x] |= gain[x];
+                            du[x] |= gain[x];
+                            newAccept = newAccept || (gain[x] & acceptMask[x]);
+                        }
+                        if (newAccept && !accepted[su]) {
+                            accepted[su] = true;
+                            tmpAdj.emplace_back(u);
+                        }
+                    }
+                }
+            }
+            for (unsigned v : visited)
+                slotOf[v] = NO_SLOT;
+            visited.clear();
+            masks.clear();
+            pendOf.clear();
+            accepted.clear();
+            frontier.clear();
+            pend.clear();
+            if (tmpAdj.size() > prevSz) {
+                ret->v2idx[sNode] = tmpOffset.size();
+                tmpOffset.emplace_back(prevSz);
+            }
+        }
+    }
+    ret->n = tmpOffset.size();
+    ret->offset = move(tmpOffset);
+    ret->m = tmpAdj.size();
+    ret->adj = move(tmpAdj);
+    return ret;
+}
+
+/**
+ * @brief Execute as the DFA of this NFA (which may have eps transitions), without building it upfront: a DFA state
+ * (the eps closure of a set of NFA states) is created, and its transition by a (label, direction) computed, the
+ * first time the traversal needs it, and kept in a cache for the following sources. The cache is flushed between
+ * sources once it holds more than maxCachedStates states, so it may exceed the bound only within one source.
+ * The sources and results are the same as those of convert2Dfa()->execute, without duplicate pairs.
+ */
+std::shared_ptr<MappedCSR> NFA::executeLazyDfa(std::shared_ptr<const MultiLabelCSR> csrPtr, size_t maxCachedStates) const {
+    return executeBatch({this}, csrPtr, maxCachedStates)[0];
+}
+
+/**
+ * @brief Evaluate several queries in one traversal: the lazy DFA (see executeLazyDfa) is built over the union of
+ * their automata, so a DFA state is a set of states of several automata, tagged with the queries it accepts, and
+ * the common prefixes of the queries are traversed once. Each query gets the sources and results of its own
+ * executeLazyDfa; an automaton may be passed more than once.
+ */
+std::vector<std::shared_ptr<MappedCSR>> NFA::executeBatch(const std::vector<const NFA *> &nfaPtrs,
+std::shared_ptr<const MultiLabelCSR> csrPtr, size_t maxCachedStates) {
+    const MultiLabelCSR &csr = *csrPtr;
+    size_t numQueries = nfaPtrs.size();
+    // Number the states of the distinct automata (slots) one after another
+    vector<const NFA *> slotNfa;
+    vector<vector<size_t>> slot2queries;
+    unordered_map<const NFA *, size_t> nfa2slot;
+    for (size_t k = 0; k < numQueries; k++) {
+        auto ins = nfa2slot.emplace(nfaPtrs[k], slotNfa.size());
+        if (ins.second) {
+            slotNfa.emplace_back(nfaPtrs[k]);
+            slot2queries.emplace_back();
+        }
+        slot2queries[ins.first->second].emplace_back(k);
+    }
+    size_t numSlots = slotNfa.size();
+    vector<const State *> allStates;
+    vector<size_t> stateSlot;
+    unordered_map<const State *, size_t> state2idx;
+    for (size_t slot = 0; slot < numSlots; slot++) {
+        for (const auto &st : slotNfa[slot]->states) {
+            state2idx[st.get()] = allStates.size();
+            allStates.emplace_back(st.get());
+            stateSlot.emplace_back(slot);
+        }
+    }
+    size_t numStates = allStates.size();
+    // The (label, direction) pairs read by some transition and present in the graph
+    vector<const MappedCSR *> stepCsr;
+    map<pair<int, bool>, size_t> step2idx;
+    for (const State *st : allStates) {
+        for (const auto &oe : st->outEdges) {
+            if (oe.lbl == -1)
+                continue;
+            auto it = csr.label2idx.find(oe.lbl);
+            if (it != csr.label2idx.end() && step2idx.emplace(make_pair(oe.lbl, oe.forward), stepCsr.size()).second)
+                stepCsr.emplace_back(oe.forward ? &csr.outCsr[it->second] : &csr.inCsr[it->second]);
+        }
+    }
+    size_t numSteps = stepCsr.size();
+
+    // Eps closures of the NFA states, computed when first needed
+    vector<vector<size_t>> closures(numStates);
+    vector<bool> hasClosure(numStates, false);
+    auto closure = [&](size_t i) -> const vector<size_t> & {
+        if (hasClosure[i])
+            return closures[i];
+        vector<bool> inClosure(numStates, false);
+        vector<size_t> &c = closures[i];
+        c.emplace_back(i);
+        inClosure[i] = true;
+        for (size_t head = 0; head < c.size(); head++) {
+            for (const auto &oe : allStates[c[head]]->outEdges) {
+                size_t j = state2idx[oe.dst.get()];
+                if (oe.lbl == -1 && !inClosure[j]) {
+                    inClosure[j] = true;
+                    c.emplace_back(j);
+                }
+            }
+        }
+        hasClosure[i] = true;
+        return c;
+    };
+
+    // The cache: NFA states (sorted) of each DFA state, the slots it accepts, the steps it has transitions by, and
+    // its transitions by each step (UNKNOWN until computed, -1 for the dead state)
+    const int UNKNOWN = -2;
+    map<vector<size_t>, int> subset2dfa;
+    vector<const vector<size_t> *> dfaSubset;
+    vector<vector<size_t>> dfaAccept, dfaSteps;
+    vector<int> dfaNext;
+    auto addDfaState = [&](vector<size_t> &subset) {
+        sort(subset.begin(), subset.end());
+        subset.erase(unique(subset.begin(), subset.end()), subset.end());
+        auto ins = subset2dfa.emplace(subset, int(dfaSubset.size()));
+        if (ins.second) {
+            dfaSubset.emplace_back(&ins.first->first);
+            dfaAccept.emplace_back();
+            for (size_t i : subset)
+                if (allStates[i]->accept && (dfaAccept.back().empty() || dfaAccept.back().back() != stateSlot[i]))
+                    dfaAccept.back().emplace_back(stateSlot[i]);    // States are numbered by slot, so no duplicates
+            dfaSteps.emplace_back();
+            for (size_t i : subset)
+                for (const auto &oe : allStates[i]->outEdges)
+                    if (oe.lbl != -1) {
+                        auto it = step2idx.find(make_pair(oe.lbl, oe.forward));
+                        if (it != step2idx.end())
+                            dfaSteps.back().emplace_back(it->second);
+                    }
+            sort(dfaSteps.back().begin(), dfaSteps.back().end());
+            dfaSteps.back().erase(unique(dfaSteps.back().begin(), dfaSteps.back().end()), dfaSteps.back().end());
+            dfaNext.insert(dfaNext.end(), numSteps, UNKNOWN);
+        }
+        return ins.first->second;
+    };
+    vector<size_t> subset, initSubset;
+    for (size_t slot = 0; slot < numSlots; slot++) {
+        const auto &c = closure(state2idx[slotNfa[slot]->initial.get()]);
+        initSubset.insert(initSubset.end(), c.begin(), c.end());
+    }
+    auto resetCache = [&]() {
+        subset2dfa.clear();
+        dfaSubset.clear();
+        dfaAccept.clear();
+        dfaSteps.clear();
+        dfaNext.clear();
+        subset = initSubset;
+        addDfaState(subset);   // DFA state 0
+    };
+    auto nextDfaState = [&](int d, size_t stepIdx) {
+        int &ret = dfaNext[d * numSteps + stepIdx];
+        if (ret != UNKNOWN)
+            return ret;
+        subset.clear();
+        for (size_t i : *dfaSubset[d])
+            for (const auto &oe : allStates[i]->outEdges)
+                if (oe.lbl != -1) {
+                    auto it = step2idx.find(make_pair(oe.lbl, oe.forward));
+                    if (it != step2idx.end() && it->second == stepIdx) {
+                        const auto &c = closure(state2idx[oe.dst.get()]);
+                        subset.insert(subset.end(), c.begin(), c.end());
+                    }
+                }
+        // Add before taking the reference again, as adding may reallocate dfaNext
+        int nextD = subset.empty() ? -1 : addDfaState(subset);
+        dfaNext[d * numSteps + stepIdx] = nextD;
+        return nextD;
+    };
+    resetCache();
+
+    // The sources of a slot are the vertices with a label its initial state reads; the union is traversed, and a
+    // slot accepting the empty path gets (s, s) only for its own sources
+    auto isSlotSrc = [&](size_t slot, unsigned sNode) {
+        for (size_t i : closure(state2idx[slotNfa[slot]->initial.get()]))
+            for (const auto &oe : allStates[i]->outEdges) {
+                if (oe.lbl == -1)
+                    continue;
+                auto it = csr.label2idx.find(oe.lbl);
+                if (it == csr.label2idx.end())
+                    continue;
+                const auto &v2idx = oe.forward ? csr.outCsr[it->second].v2idx : csr.inCsr[it->second].v2idx;
+                if (v2idx.find(sNode) != v2idx.end())
+                    return true;
+            }
+        return false;
+    };
+
+    // Visited rows stamped with the source, one per DFA state id; stale stamps never match a later source, so rows
+    // are reused across cache flushes without clearing, and those beyond maxCachedStates are released on a flush
+    size_t gN = csr.maxNode + 1;
+    vector<vector<int>> visRows;
+    queue<pair<unsigned, int>> q;
+    vector<pair<size_t, unsigned>> hits;    // (slot, vertex) accepted from the current source
+    vector<vector<unsigned>> tmpAdj(numQueries), tmpOffset(numQueries);
+    vector<shared_ptr<MappedCSR>> ret(numQueries);
+    for (auto &r : ret)
+        r = make_shared<MappedCSR>();
+    unordered_set<unsigned> src;
+    AdjInterval aitv;
+    for (size_t i : initSubset) {
+        for (const auto &initOut : allStates[i]->outEdges) {
+            if (initOut.lbl == -1)
+                continue;
+            auto it = csr.label2idx.find(initOut.lbl);
+            if (it == csr.label2idx.end())
+                continue;
+            const auto &v2idx = initOut.forward ? csr.outCsr[it->second].v2idx : csr.inCsr[it->second].v2idx;
+            for (const auto &spr : v2idx) {
+                unsigned sNode = spr.first;
+                if (!src.emplace(sNode).second)
+                    continue;
+                if (dfaSubset.size() > maxCachedStates) {
+                    resetCache();
+                    if (visRows.size() > maxCachedStates)
+                        visRows.resize(maxCachedStates);
+                }
+                if (visRows.empty())
+                    visRows.emplace_back(gN, -1);
+                visRows[0][sNode] = sNode;
+                for (size_t slot : dfaAccept[0])
+                    if (numSlots == 1 || isSlotSrc(slot, sNode))
+                        hits.emplace_back(slot, sNode);
+                q.emplace(sNode, 0);
+                while (!q.empty()) {
+                    auto cur = q.front();
+                    q.pop();
+                    unsigned v = cur.first;
+                    int d = cur.second;
+                    // Index dfaSteps each time, as nextDfaState may add DFA states and reallocate it
+                    for (size_t k = 0; k < dfaSteps[d].size(); k++) {
+                        size_t stepIdx = dfaSteps[d][k];
+                        stepCsr[stepIdx]->getAdjIntervalByVert(v, aitv);
+                        if (aitv.len == 0)
+                            continue;
+                        int nextD = nextDfaState(d, stepIdx);   // Never dead, as d has a transition by the step
+                        while (visRows.size() <= size_t(nextD))
+                            visRows.emplace_back(gN, -1);
+                        vector<int> &row = visRows[nextD];
+                        for (size_t j = 0; j < aitv.len; j++) {
+                            unsigned nextV = (*aitv.start)[aitv.offset + j];
+                            if (row[nextV] != int(sNode)) {
+                                row[nextV] = sNode;
+                                q.emplace(nextV, nextD);
+                                for (size_t slot : dfaAccept[nextD])
+                                    hits.emplace_back(slot, nextV);
+                            }
+                        }
+                    }
+                }
+                // A vertex may be reached in several DFA states accepting the same slot
+                sort(hits.begin(), hits.end());
+                hits.erase(unique(hits.begin(), hits.end()), hits.end());
+                for (size_t j = 0; j < hits.size(); ) {
+                    size_t slot = hits[j].first, slotEnd = j;
+                    while (slotEnd < hits.size() && hits[slotEnd].first == slot)
+                        slotEnd++;
+                    for (size_t k : slot2queries[slot]) {
+                        ret[k]->v2idx[sNode] = tmpOffset[k].size();
+                        tmpOffset[k].emplace_back(tmpAdj[k].size());
+                        for (size_t x = j; x < slotEnd; x++)
+                            tmpAdj[k].emplace_back(hits[x].second);
+                    }
+                    j = slotEnd;
+                }
+                hits.clear();
+            }
+        }
+    }
+    for (size_t k = 0; k < numQueries; k++) {
+        ret[k]->n = tmpOffset[k].size();
+        ret[k]->offset = move(tmpOffset[k]);
+        ret[k]->m = tmpAdj[k].size();
+        ret[k]->adj = move(tmpAdj[k]);
+    }
+    return ret;
+}
+
 void NFA::clearVis(unsigned gN) {
     size_t numStates = states.size();
     if (!vis) {
@@ -455,4 +1194,28 @@ void NFA::clearVis(unsigned gN) {
         for (size_t j = 0; j < numStates; j++)
             memset(vis[j], -1, gN * sizeof(int));
     }
-}
\ No newline at end of file
+}
+void VisBuffer::reserve(size_t numStates, size_t gN_) {
+    if (gN_ != gN) {
+        // Different graph size: reallocate all rows
+        for (int *row : rows)
+            delete []row;
+        rows.clear();
+        gN = gN_;
+        mark = INT_MIN;
+    }
+    while (rows.size() < numStates) {
+        rows.emplace_back(new int [gN]);
+        memset(rows.back(), -1, gN * sizeof(int));
+    }
+}
+
+int VisBuffer::nextMark() {
+    if (mark == -1) {
+        // Marks exhausted (-1 is the cleared value): clear the rows and start over
+        for (int *row : rows)
+            memset(row, -1, gN * sizeof(int));
+        mark = INT_MIN;
+    }
+    return mark++;
+}
@@ -10,8 +10,29 @@
 #include "Util.h"
 #include "CSR.h"
 
+#define PULLALPHA 14    // Closure BFS pulls once the frontier's edges exceed the unexplored edges / PULLALPHA
+#define PUSHBETA 24 // and pushes again once the frontier has fewer than #unvisited candidate vertices / PUSHBETA
+
 struct State;    // Forward definition for Transition
 
+/**
+ * @brief Visited buffer of one thread for NFA::checkIfValidSrc: one epoch-stamped row per state,
+ * rows allocated on demand. Each probe takes a fresh mark instead of clearing the rows.
+ */
+struct VisBuffer
+{
+    std::vector<int *> rows;
+    size_t gN;
+    int mark;
+    VisBuffer(): gN(0), mark(INT_MIN) {}
+    VisBuffer(const VisBuffer &) = delete;
+    VisBuffer &operator = (const VisBuffer &) = delete;
+    ~VisBuffer() { for (int *row : rows) delete []row; }
+    void reserve(size_t numStates, size_t gN_);   // Ensure rows for states [0, numStates) of gN_ entries each
+    int nextMark();
+    int **data() { return rows.data(); }
+};
+
 struct Transition
 {
     int lbl;    // -1 stands for eps
@@ -60,11 +81,28 @@ struct NFA
     std::shared_ptr<NFA> convert2Dfa();
     void findEpsClosure(std::unordered_map<int, std::unordered_set<int>> &closures);
     void reverse();
+    bool sameNonEmptyLanguage(const NFA &other, size_t maxPairs=4096) const;   // Language equality up to the empty word; both eps-free
+    std::shared_ptr<NFA> reversed() const;  // Eps-free automaton of the reversed paths of this eps-free one
+    bool cheaperBackward(const MultiLabelCSR &csr) const;   // Whether the accepted paths have fewer ends than starts
+    std::shared_ptr<NFA> minimize() const;  // Same language with bisimilar states merged (the minimal DFA if deterministic)
 
     int **vis;
     bool outerVis;
     std::shared_ptr<MappedCSR> execute(std::shared_ptr<const MultiLabelCSR> csrPtr);
+    bool isSingleLabelClosure(int &lbl, bool &forward) const;   // Whether it accepts exactly lbl+ or lbl*
+    std::shared_ptr<MappedCSR> executeClosure(const MultiLabelCSR &csr, int lbl, bool forward) const;
+    // Same result as execute for an eps-free NFA, with a bitmask of states per reached vertex instead of vis
+    std::shared_ptr<MappedCSR> executeBitParallel(std::shared_ptr<const MultiLabelCSR> csrPtr) const;
+    // Same result as convert2Dfa()->execute, building the DFA states the traversal reaches on the fly
+    std::shared_ptr<MappedCSR> executeLazyDfa(std::shared_ptr<const MultiLabelCSR> csrPtr, size_t maxCachedStates=1024) const;
+    // Results of each of the automata in one traversal of their union, as from executeLazyDfa of each
+    static std::vector<std::shared_ptr<MappedCSR>> executeBatch(const std::vector<const NFA *> &nfaPtrs,
+        std::shared_ptr<const MultiLabelCSR> csrPtr, size_t maxCachedStates=1024);
+    // Same result as execute, traversing from the ends of the paths if cheaperBackward
+    std::shared_ptr<MappedCSR> executeCheaperDirection(std::shared_ptr<const MultiLabelCSR> csrPtr);
     bool checkIfValidSrc(size_t dataNode, std::shared_ptr<const MultiLabelCSR> csrPtr, int curVisMark);
+    // Same, with the caller's visited buffer (one row per state), so probes can run concurrently
+    bool checkIfValidSrc(size_t dataNode, const MultiLabelCSR &csr, int curVisMark, int **curVis) const;
     void clearVis(unsigned gN);
 
     NFA(): curMaxId(0), vis(nullptr), outerVis(false) {
@@ -0,0 +1,110 @@
+/**
+ * @file OnlineViewManager.cpp
+ * @brief Implements methods in OnlineViewManager.h
+ * @date 2024-04-08
+ */
+
+#include "OnlineViewManager.h"
+using namespace std;
+
+// Number of chosen views, excluding the leaves (which are always materialized)
+static size_t countViews(const AndOrDag &aod) {
+    size_t ret = 0, numNodes = aod.getNumNodes();
+    for (size_t i = 0; i < numNodes; i++)
+        if (aod.isMaterialized(i) && !aod.getNodes()[i].getChildIdx().empty())
+            ret++;
+    return ret;
+}
+
+/**
+ * @brief Record q in the sliding window (starting a background re-selection if one is due) and answer it
+ * from the serving snapshot, ad hoc if q is not in it. Before the first snapshot, queries are evaluated
+ * by their DFAs, with the (v, v) pairs of epsilon explicit.
+ *
+ * @param q the query
+ * @param qr the result; if not newed, it points into the returned snapshot
+ * @return the snapshot that answered q (nullptr if answered by the DFA)
+ */
+std::shared_ptr<AndOrDag> OnlineViewManager::execute(const std::string &q, QueryResult &qr) {
+    bool due = false;
+    {
+        lock_guard<mutex> lock(trackerMutex);
+        tracker.record(q);
+        due = reselectPeriod > 0 && ++numSinceReselect >= reselectPeriod;
+    }
+    if (due)
+        reselect();
+    auto curAodPtr = getAod();
+    if (curAodPtr) {
+        if (curAodPtr->getQ2idx().find(q) != curAodPtr->getQ2idx().end())
+            curAodPtr->execute(q, qr);
+        else {
+            lock_guard<mutex> lock(adHocMutex);
+            curAodPtr->executeAdHoc(q, qr);
+        }
+        return curAodPtr;
+    }
+    shared_ptr<const NFA> dfaPtr = AutomatonCache::instance().get(q);
+    shared_ptr<MappedCSR> res = dfaPtr->executeBitParallel(csrPtr);
+    qr.csrPtr = new MappedCSR(std::move(*res));
+    qr.newed = true;
+    qr.hasEpsilon = false;
+    return nullptr;
+}
+
+bool OnlineViewManager::reselect(bool background) {
+    bool expected = false;
+    if (!reselecting.compare_exchange_strong(expected, true))
+        return false;
+    {
+        lock_guard<mutex> lock(workerMutex);
+        if (worker.joinable())
+            worker.join();  // The previous re-selection has finished
+    }
+    unordered_map<string, size_t> q2freq;
+    {
+        lock_guard<mutex> lock(trackerMutex);
+        q2freq = tracker.getQ2freq();
+        numSinceReselect = 0;
+    }
+    if (background) {
+        lock_guard<mutex> lock(workerMutex);
+        worker = thread(&OnlineViewManager::reselectTask, this, std::move(q2freq));
+    } else
+        reselectTask(std::move(q2freq));
+    return true;
+}
+
+void OnlineViewManager::waitReselect() {
+    lock_guard<mutex> lock(workerMutex);
+    if (worker.joinable())
+        worker.join();
+}
+
+// Build, plan and materialize a snapshot over q2freq, reusing the views of the serving snapshot, then swap it in
+void OnlineViewManager::reselectTask(std::unordered_map<std::string, size_t> q2freq) {
+    auto newAodPtr = make_shared<AndOrDag>(csrPtr);
+    for (const auto &pr : q2freq)
+        newAodPtr->addWorkloadQuery(pr.first, pr.second);
+    newAodPtr->initAuxiliary();
+    newAodPtr->annotateLeafCostCard();
+    newAodPtr->plan();
+    size_t usedSpace = 0;
+    newAodPtr->chooseMatViews(mode, usedSpace, budget);
+    auto oldAodPtr = getAod();
+    size_t numViews = countViews(*newAodPtr), numOldViews = 0, kept = 0;
+    if (oldAodPtr) {
+        lock_guard<mutex> lock(adHocMutex);
+        numOldViews = countViews(*oldAodPtr);
+        kept = newAodPtr->adoptViews(*oldAodPtr);
+    }
+    newAodPtr->materialize();
+    {
+        lock_guard<mutex> lock(statsMutex);
+        numKept = kept;
+        numAdded = numViews - kept;
+        numDropped = numOldViews - kept;
+    }
+    std::atomic_store(&aodPtr, newAodPtr);
+    reselecting = false;
+}
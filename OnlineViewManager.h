@@ -0,0 +1,56 @@
+/**
+ * @file OnlineViewManager.h
+ * @brief Answers queries while re-selecting the materialized views as the query mix drifts
+ * @date 2024-04-08
+ */
+
+#pragma once
+#include "AndOrDag.h"
+#include "WorkloadTracker.h"
+#include <thread>
+
+/**
+ * @brief Serves queries from a planned and materialized AndOrDag snapshot built over the queries in a sliding
+ * window. Every reselectPeriod queries (or on reselect()), a new snapshot is built from the current window in a
+ * background thread: plan, choose views under the budget, adopt the views of the serving snapshot that are chosen
+ * again, and materialize only the new ones. The finished snapshot then replaces the serving one atomically, so
+ * queries never wait for re-selection; views not chosen again are dropped with the old snapshot. Queries outside the
+ * window are answered ad hoc on top of the serving snapshot's views.
+ *
+ * execute() is meant to be called from a single query thread; re-selection runs concurrently with it.
+ */
+class OnlineViewManager {
+    std::shared_ptr<MultiLabelCSR> csrPtr;
+    WorkloadTracker tracker;
+    std::mutex trackerMutex;
+    std::shared_ptr<AndOrDag> aodPtr;   // Serving snapshot; accessed with std::atomic_load/std::atomic_store
+    std::mutex adHocMutex;  // Ad-hoc queries add nodes to the serving snapshot temporarily; adopting its views waits for them
+    size_t budget;  // Space budget of the views (#node pairs, estimated)
+    char mode;  // View selection mode of AndOrDag::chooseMatViews
+    size_t reselectPeriod;  // Re-select after this many queries (0: only on reselect())
+    size_t numSinceReselect;
+    std::thread worker;
+    std::mutex workerMutex; // reselect() and waitReselect() may both join worker
+    std::atomic<bool> reselecting;
+    // Statistics of the last re-selection; written by the worker, so read under statsMutex
+    size_t numAdded, numKept, numDropped;
+    mutable std::mutex statsMutex;
+
+    void reselectTask(std::unordered_map<std::string, size_t> q2freq);
+public:
+    OnlineViewManager(std::shared_ptr<MultiLabelCSR> csrPtr_, size_t windowSz, size_t budget_, size_t reselectPeriod_=0, char mode_=0):
+    csrPtr(csrPtr_), tracker(windowSz), aodPtr(nullptr), budget(budget_), mode(mode_), reselectPeriod(reselectPeriod_),
+    numSinceReselect(0), reselecting(false), numAdded(0), numKept(0), numDropped(0) {}
+    ~OnlineViewManager() { waitReselect(); }
+    OnlineViewManager(const OnlineViewManager &) = delete;
+    OnlineViewManager &operator=(const OnlineViewManager &) = delete;
+
+    // Record q in the window and answer it; qr may point into the returned snapshot, so hold it while using qr
+    std::shared_ptr<AndOrDag> execute(const std::string &q, QueryResult &qr);
+    bool reselect(bool background=true);    // Start a re-selection over the current window; false if one is running
+    void waitReselect();    // Wait for the running re-selection (if any) to be swapped in
+    std::shared_ptr<AndOrDag> getAod() const { return std::atomic_load(&aodPtr); }
+    size_t getNumAdded() const { std::lock_guard<std::mutex> lock(statsMutex); return numAdded; }
+    size_t getNumKept() const { std::lock_guard<std::mutex> lock(statsMutex); return numKept; }
+    size_t getNumDropped() const { std::lock_guard<std::mutex> lock(statsMutex); return numDropped; }
+};
@@ -0,0 +1,347 @@
+/**
+ * @file ReachIndex.cpp
+ * @brief Implements methods in ReachIndex.h
+ * @date 2024-03-18
+ */
+
+#include "ReachIndex.h"
+using namespace std;
+
+/**
+ * @brief Build the index of rel+ (pairs connected by a non-empty path of rel)
+ *
+ * @param rel the relation to close, e.g., the result of a Kleene node's child
+ */
+void ReachIndex::build(const MappedCSR &rel) {
+    build(vector<const MappedCSR *>({&rel}));
+}
+
+/**
+ * @brief Build the index of (rel_1 | rel_2 | ...)+ without materializing the union,
+ * e.g., a label-constrained reachability index over the per-label CSRs of a label set
+ *
+ * @param rels the relations whose union is closed
+ */
+void ReachIndex::build(const std::vector<const MappedCSR *> &rels) {
+    // Map the vertices of the relations to consecutive local ids
+    unordered_map<unsigned, unsigned> v2local;
+    vector<unsigned> local2v;
+    size_t numEdges = 0;
+    for (const MappedCSR *relPtr : rels) {
+        for (const auto &pr : relPtr->v2idx) {
+            if (v2local.emplace(pr.first, local2v.size()).second)
+                local2v.emplace_back(pr.first);
+        }
+        for (unsigned x : relPtr->adj) {
+            if (v2local.emplace(x, local2v.size()).second)
+                local2v.emplace_back(x);
+        }
+        numEdges += relPtr->adj.size();
+    }
+    unsigned numLocal = local2v.size();
+    vector<unsigned> lOff(numLocal + 1, 0), lAdj(numEdges);
+    for (const MappedCSR *relPtr : rels) {
+        for (const auto &pr : relPtr->v2idx) {
+            size_t adjStart = relPtr->offset[pr.second], adjEnd = pr.second < relPtr->n - 1 ? relPtr->offset[pr.second + 1] : relPtr->adj.size();
+            lOff[v2local[pr.first] + 1] += adjEnd - adjStart;
+        }
+    }
+    for (unsigned i = 0; i < numLocal; i++)
+        lOff[i + 1] += lOff[i];
+    vector<unsigned> fillPos(lOff.begin(), lOff.end() - 1);
+    for (const MappedCSR *relPtr : rels) {
+        for (const auto &pr : relPtr->v2idx) {
+            size_t adjStart = relPtr->offset[pr.second], adjEnd = pr.second < relPtr->n - 1 ? relPtr->offset[pr.second + 1] : relPtr->adj.size();
+            unsigned &pos = fillPos[v2local[pr.first]];
+            for (size_t i = adjStart; i < adjEnd; i++)
+                lAdj[pos++] = v2local[relPtr->adj[i]];
+        }
+    }
+    buildDag(numLocal, lOff, lAdj, local2v);
+    buildLabels();
+}
+
+/**
+ * @brief Find SCCs with an iterative Tarjan and build the condensation DAG.
+ * SCC ids are assigned in completion order, so every DAG edge goes from a larger id to a smaller one.
+ */
+void ReachIndex::buildDag(unsigned numLocal, const std::vector<unsigned> &lOff, const std::vector<unsigned> &lAdj,
+const std::vector<unsigned> &local2v) {
+    vector<int> dfn(numLocal, -1);
+    vector<unsigned> low(numLocal, 0), comp(numLocal, 0), st;
+    vector<bool> onStack(numLocal, false);
+    vector<pair<unsigned, unsigned>> callStack;   // (local id, next edge position)
+    int curDfn = 0;
+    numComp = 0;
+    for (unsigned r = 0; r < numLocal; r++) {
+        if (dfn[r] != -1)
+            continue;
+        callStack.emplace_back(r, lOff[r]);
+        dfn[r] = low[r] = curDfn++;
+        st.emplace_back(r);
+        onStack[r] = true;
+        while (!callStack.empty()) {
+            unsigned u = callStack.back().first;
+            unsigned &pos = callStack.back().second;
+            if (pos < lOff[u + 1]) {
+                unsigned w = lAdj[pos++];
+                if (dfn[w] == -1) {
+                    dfn[w] = low[w] = curDfn++;
+                    st.emplace_back(w);
+                    onStack[w] = true;
+                    callStack.emplace_back(w, lOff[w]);
+                } else if (onStack[w] && unsigned(dfn[w]) < low[u])
+                    low[u] = dfn[w];
+                continue;
+            }
+            callStack.pop_back();
+            if (!callStack.empty() && low[u] < low[callStack.back().first])
+                low[callStack.back().first] = low[u];
+            if (low[u] == unsigned(dfn[u])) {
+                unsigned w = 0;
+                do {
+                    w = st.back();
+                    st.pop_back();
+                    onStack[w] = false;
+                    comp[w] = numComp;
+                } while (w != u);
+                numComp++;
+            }
+        }
+    }
+
+    // Members, cyclic flags
+    compOffset.assign(numComp + 1, 0);
+    for (unsigned u = 0; u < numLocal; u++)
+        compOffset[comp[u] + 1]++;
+    for (unsigned c = 0; c < numComp; c++)
+        compOffset[c + 1] += compOffset[c];
+    compMember.assign(numLocal, 0);
+    vector<unsigned> fillPos(compOffset.begin(), compOffset.end() - 1);
+    v2comp.clear();
+    v2comp.reserve(numLocal);
+    for (unsigned u = 0; u < numLocal; u++) {
+        compMember[fillPos[comp[u]]++] = local2v[u];
+        v2comp.emplace(local2v[u], comp[u]);
+    }
+    compCyclic.assign(numComp, false);
+    for (unsigned c = 0; c < numComp; c++)
+        if (compOffset[c + 1] - compOffset[c] > 1)
+            compCyclic[c] = true;
+
+    // Deduplicated condensation edges
+    vector<pair<unsigned, unsigned>> edges;
+    for (unsigned u = 0; u < numLocal; u++) {
+        for (unsigned i = lOff[u]; i < lOff[u + 1]; i++) {
+            unsigned w = lAdj[i];
+            if (comp[u] != comp[w])
+                edges.emplace_back(comp[u], comp[w]);
+            else if (u == w)
+                compCyclic[comp[u]] = true;
+        }
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+    dagOffset.assign(numComp + 1, 0);
+    dagInOffset.assign(numComp + 1, 0);
+    for (const auto &e : edges) {
+        dagOffset[e.first + 1]++;
+        dagInOffset[e.second + 1]++;
+    }
+    for (unsigned c = 0; c < numComp; c++) {
+        dagOffset[c + 1] += dagOffset[c];
+        dagInOffset[c + 1] += dagInOffset[c];
+    }
+    dagAdj.assign(edges.size(), 0);
+    dagInAdj.assign(edges.size(), 0);
+    vector<unsigned> inPos(dagInOffset.begin(), dagInOffset.end() - 1);
+    for (size_t i = 0; i < edges.size(); i++) {
+        dagAdj[i] = edges[i].second;    // edges are sorted by source
+        dagInAdj[inPos[edges[i].second]++] = edges[i].first;
+    }
+}
+
+/**
+ * @brief Pruned landmark labeling on the condensation DAG, landmarks in descending degree order.
+ * Lout(u) and Lin(v) share a landmark iff u reaches v (u == v included).
+ */
+void ReachIndex::buildLabels() {
+    vector<unsigned> order(numComp);
+    for (unsigned c = 0; c < numComp; c++)
+        order[c] = c;
+    sort(order.begin(), order.end(), [this](unsigned a, unsigned b) {
+        size_t da = size_t(dagOffset[a + 1] - dagOffset[a] + 1) * (dagInOffset[a + 1] - dagInOffset[a] + 1);
+        size_t db = size_t(dagOffset[b + 1] - dagOffset[b] + 1) * (dagInOffset[b + 1] - dagInOffset[b] + 1);
+        return da > db || (da == db && a < b);
+    });
+    vector<vector<unsigned>> lOut(numComp), lIn(numComp);
+    auto query = [&lOut, &lIn](unsigned a, unsigned b) {
+        const auto &x = lOut[a], &y = lIn[b];
+        size_t i = 0, j = 0;
+        while (i < x.size() && j < y.size()) {
+            if (x[i] == y[j])
+                return true;
+            if (x[i] < y[j])
+                i++;
+            else
+                j++;
+        }
+        return false;
+    };
+    vector<unsigned> vis(numComp, 0), q;
+    unsigned mark = 0;
+    for (unsigned r = 0; r < numComp; r++) {
+        unsigned k = order[r];
+        // Forward: k joins Lin of the DAG nodes it reaches that are not covered yet
+        mark++;
+        q.assign(1, k);
+        vis[k] = mark;
+        for (size_t h = 0; h < q.size(); h++) {
+            unsigned w = q[h];
+            if (query(k, w))
+                continue;
+            lIn[w].emplace_back(r);
+            for (unsigned i = dagOffset[w]; i < dagOffset[w + 1]; i++) {
+                if (vis[dagAdj[i]] != mark) {
+                    vis[dagAdj[i]] = mark;
+                    q.emplace_back(dagAdj[i]);
+                }
+            }
+        }
+        // Backward: k joins Lout of the DAG nodes reaching it
+        mark++;
+        q.assign(1, k);
+        vis[k] = mark;
+        for (size_t h = 0; h < q.size(); h++) {
+            unsigned w = q[h];
+            if (query(w, k))
+                continue;
+            lOut[w].emplace_back(r);
+            for (unsigned i = dagInOffset[w]; i < dagInOffset[w + 1]; i++) {
+                if (vis[dagInAdj[i]] != mark) {
+                    vis[dagInAdj[i]] = mark;
+                    q.emplace_back(dagInAdj[i]);
+                }
+            }
+        }
+    }
+    outLblOffset.assign(numComp + 1, 0);
+    inLblOffset.assign(numComp + 1, 0);
+    outLbl.clear();
+    inLbl.clear();
+    for (unsigned c = 0; c < numComp; c++) {
+        outLbl.insert(outLbl.end(), lOut[c].begin(), lOut[c].end());
+        inLbl.insert(inLbl.end(), lIn[c].begin(), lIn[c].end());
+        outLblOffset[c + 1] = outLbl.size();
+        inLblOffset[c + 1] = inLbl.size();
+    }
+}
+
+bool ReachIndex::dagReach(unsigned cu, unsigned cv) const {
+    unsigned i = outLblOffset[cu], iEnd = outLblOffset[cu + 1], j = inLblOffset[cv], jEnd = inLblOffset[cv + 1];
+    while (i < iEnd && j < jEnd) {
+        if (outLbl[i] == inLbl[j])
+            return true;
+        if (outLbl[i] < inLbl[j])
+            i++;
+        else
+            j++;
+    }
+    return false;
+}
+
+bool ReachIndex::reach(unsigned u, unsigned v) const {
+    auto itU = v2comp.find(u), itV = v2comp.find(v);
+    if (itU == v2comp.end() || itV == v2comp.end())
+        return false;
+    if (itU->second == itV->second)
+        return compCyclic[itU->second];
+    return dagReach(itU->second, itV->second);
+}
+
+// Collect the SCCs reachable from c by a non-empty path (reaching c if reverse)
+void ReachIndex::collectComps(unsigned c, bool reverse, std::vector<unsigned> &comps,
+std::vector<unsigned> &vis, unsigned mark) const {
+    const vector<unsigned> &off = reverse ? dagInOffset : dagOffset;
+    const vector<unsigned> &adj = reverse ? dagInAdj : dagAdj;
+    comps.clear();
+    if (compCyclic[c])
+        comps.emplace_back(c);
+    vis[c] = mark;
+    size_t h = comps.size();
+    for (unsigned i = off[c]; i < off[c + 1]; i++) {
+        if (vis[adj[i]] != mark) {
+            vis[adj[i]] = mark;
+            comps.emplace_back(adj[i]);
+        }
+    }
+    for (; h < comps.size(); h++) {
+        unsigned w = comps[h];
+        for (unsigned i = off[w]; i < off[w + 1]; i++) {
+            if (vis[adj[i]] != mark) {
+                vis[adj[i]] = mark;
+                comps.emplace_back(adj[i]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Expand the closure from the given vertices and append the rows to res.
+ * Vertices in the same SCC share one DAG traversal.
+ *
+ * @param vVec sources (if !reverse) or targets (if reverse); duplicates are ignored
+ * @param reverse whether vVec holds targets
+ * @param res the result CSR, rows are always keyed by sources
+ */
+void ReachIndex::expand(const std::vector<unsigned> &vVec, bool reverse, MappedCSR &res) const {
+    unordered_map<unsigned, vector<unsigned>> comp2v;
+    for (unsigned v : vVec) {
+        auto it = v2comp.find(v);
+        if (it != v2comp.end())
+            comp2v[it->second].emplace_back(v);
+    }
+    vector<unsigned> vis(numComp, 0), comps;
+    unsigned mark = 0;
+    unordered_map<unsigned, vector<unsigned>> tmpNode2Adj;  // For reverse, rows are assembled afterwards
+    for (auto &pr : comp2v) {
+        collectComps(pr.first, reverse, comps, vis, ++mark);
+        if (comps.empty())
+            continue;
+        sort(pr.second.begin(), pr.second.end());
+        pr.second.erase(unique(pr.second.begin(), pr.second.end()), pr.second.end());
+        for (unsigned v : pr.second) {
+            if (!reverse) {
+                if (res.v2idx.find(v) != res.v2idx.end())
+                    continue;
+                res.v2idx[v] = res.offset.size();
+                res.offset.emplace_back(res.adj.size());
+                for (unsigned c : comps)
+                    res.adj.insert(res.adj.end(), compMember.begin() + compOffset[c], compMember.begin() + compOffset[c + 1]);
+            } else {
+                for (unsigned c : comps)
+                    for (unsigned i = compOffset[c]; i < compOffset[c + 1]; i++)
+                        tmpNode2Adj[compMember[i]].emplace_back(v);
+            }
+        }
+    }
+    for (auto &pr : tmpNode2Adj) {
+        if (res.v2idx.find(pr.first) != res.v2idx.end())
+            continue;
+        res.v2idx[pr.first] = res.offset.size();
+        res.offset.emplace_back(res.adj.size());
+        move(pr.second.begin(), pr.second.end(), std::back_inserter(res.adj));
+    }
+    res.n = res.v2idx.size();
+    res.m = res.adj.size();
+}
+
+void ReachIndex::expandAll(MappedCSR &res) const {
+    vector<unsigned> vVec(compMember);
+    expand(vVec, false, res);
+}
+
+size_t ReachIndex::size() const {
+    return 2 * v2comp.size() + compMember.size() + compOffset.size() + dagOffset.size() + dagAdj.size() \
+        + dagInOffset.size() + dagInAdj.size() + outLblOffset.size() + outLbl.size() + inLblOffset.size() + inLbl.size();
+}
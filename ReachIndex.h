@@ -0,0 +1,37 @@
+/**
+ * @file ReachIndex.h
+ * @brief Compact reachability index for materialized Kleene closure views
+ * @date 2024-03-18
+ */
+
+#pragma once
+#include "CSR.h"
+
+/**
+ * @brief Stores the transitive closure (+) of a relation as its SCC condensation plus
+ * pruned landmark labels (2-hop) on the condensation DAG instead of explicit pairs.
+ * Point lookups intersect two label lists; full expansions walk the condensation DAG.
+ */
+struct ReachIndex {
+    unsigned numComp;
+    std::unordered_map<unsigned, unsigned> v2comp;  // Vertex -> SCC id (only vertices of the relation)
+    std::vector<unsigned> compOffset, compMember;   // Members of each SCC (offset has numComp + 1 entries)
+    std::vector<bool> compCyclic;   // Whether the members of an SCC reach themselves (size > 1 or self loop)
+    std::vector<unsigned> dagOffset, dagAdj, dagInOffset, dagInAdj;    // Condensation DAG out/in edges
+    std::vector<unsigned> outLblOffset, outLbl, inLblOffset, inLbl;    // Landmark labels (ranks, sorted)
+
+    ReachIndex(): numComp(0) {}
+    void build(const MappedCSR &rel);   // Build the index of rel+
+    void build(const std::vector<const MappedCSR *> &rels); // Build the index of (rel_1 | rel_2 | ...)+
+    bool reach(unsigned u, unsigned v) const;   // Whether (u, v) is in rel+
+    // Append the rows of all sources in srcs (or of all sources reaching tgts if reverse) to res
+    void expand(const std::vector<unsigned> &vVec, bool reverse, MappedCSR &res) const;
+    void expandAll(MappedCSR &res) const;
+    size_t size() const;    // Number of stored entries, comparable to the number of pairs of a MappedCSR
+private:
+    void buildDag(unsigned numLocal, const std::vector<unsigned> &lOff, const std::vector<unsigned> &lAdj,
+        const std::vector<unsigned> &local2v);
+    void buildLabels();
+    bool dagReach(unsigned cu, unsigned cv) const;
+    void collectComps(unsigned c, bool reverse, std::vector<unsigned> &comps, std::vector<unsigned> &vis, unsigned mark) const;
+};
@@ -9,34 +9,29 @@
 
 using namespace std;
 
+/**
+ * @brief The elements of the query if it is a concatenation (with unmodified groups of concatenations spliced in),
+ * or the query itself if a single element; v is left as is for an alternation.
+ */
 void Rpq2NFAConvertor::getClauses(const std::string &query, std::vector<std::string> &v) {
-    istringstream ifs(query);
-    RpqErrorListener lstnr;
-
-    antlr4::ANTLRInputStream input(ifs);
-    rpqLexer lexer(&input);
-    lexer.removeErrorListeners();
-    lexer.addErrorListener(&lstnr);
-
-    antlr4::CommonTokenStream tokens(&lexer);
-    rpqParser parser(&tokens);
-    parser.removeErrorListeners();
-    parser.addErrorListener(&lstnr);
-
-    rpqParser::PathContext *path = parser.path();
-    if (path->pathSequence().size() > 1)
+    RpqAst ast;
+    ast.parse(query);
+    size_t root = ast.getRoot();
+    if (ast.getNodes()[root].type == '|')
         return;
     v.clear();
-    getClausesSinglePath(path, v);
-}
-
-void Rpq2NFAConvertor::getClausesSinglePath(rpqParser::PathContext *path, std::vector<std::string> &v) {
-    std::vector<rpqParser::PathEltContext *> cVec = path->pathSequence()[0]->pathElt();
-    for (const auto &c : cVec) {
-        if (!c->pathMod() && c->pathPrimary()->path())
-            getClausesSinglePath(c->pathPrimary()->path(), v);
+    vector<size_t> stk(1, root);
+    while (!stk.empty()) {
+        size_t idx = stk.back();
+        stk.pop_back();
+        const auto &node = ast.getNodes()[idx];
+        if (node.type == '/') {
+            for (size_t i = node.numChildren; i > 0; i--)
+                stk.emplace_back(ast.getChildren(idx)[i - 1]);
+        } else if (node.type == '|')
+            v.emplace_back("(" + ast.toString(idx) + ")");
         else
-            v.emplace_back(c->getText());
+            v.emplace_back(ast.toString(idx));
     }
 }
 
@@ -48,52 +43,43 @@ void Rpq2NFAConvertor::getClausesSinglePath(rpqParser::PathContext *path, std::v
  */
 shared_ptr<NFA> Rpq2NFAConvertor::convert(const string &query)
 {
-    shared_ptr<NFA> nfa_ptr = make_shared<NFA>();
-    try
-    {
-        istringstream ifs(query);
-        RpqErrorListener lstnr;
-
-        antlr4::ANTLRInputStream input(ifs);
-	    rpqLexer lexer(&input);
-	    lexer.removeErrorListeners();
-	    lexer.addErrorListener(&lstnr);
-
-	    antlr4::CommonTokenStream tokens(&lexer);
-	    rpqParser parser(&tokens);
-	    parser.removeErrorListeners();
-	    parser.addErrorListener(&lstnr);
+    RpqAst ast;
+    ast.parse(query);
+    return convert(ast, ast.getRoot());
+}
 
-	    rpqParser::PathContext *path = parser.path();
-	    visitPath(path, nfa_ptr);
-	}
-    catch(const runtime_error& e1)
-    {
-		throw runtime_error(e1.what());
-    }
+shared_ptr<NFA> Rpq2NFAConvertor::convert(RpqAst &ast, size_t idx)
+{
+    shared_ptr<NFA> nfa_ptr = make_shared<NFA>();
+    convert(ast, idx, nfa_ptr);
     return nfa_ptr;
 }
 
 /**
- * @brief path : pathAlternative ;
+ * @brief Thompson-style construction of the sub-expression idx into nfa_ptr (a fresh NFA).
+ * 
+ * Alternation: a fresh NFA per branch, entered by an epsilon transition from the initial state.
+ * Concat: a fresh NFA per element, entered by epsilon transitions from the accept states so far.
+ * Modifiers: epsilon transitions from the accept states back to the initial state (* and +), and the initial
+ * state accepting (* and ?).
+ * Label: a transition from the initial state to a new accept state.
  * 
- * @param ctx pointer to path's context
+ * @param ast the parsed query
+ * @param idx the node of the sub-expression in ast
  * @param nfa_ptr pointer to the NFA to be constructed
- * @return antlrcpp::Any a dummy antlrcpp::Any object
  */
-antlrcpp::Any
-Rpq2NFAConvertor::visitPath(rpqParser::PathContext *ctx, shared_ptr<NFA> nfa_ptr)
+void Rpq2NFAConvertor::convert(RpqAst &ast, size_t idx, shared_ptr<NFA> nfa_ptr)
 {
-    if ((ctx->pathSequence()).size() == 1)
-        visitPathSequence(ctx->pathSequence(0), nfa_ptr);
-    else
+    const auto &node = ast.getNodes()[idx];
+    const size_t *childIdx = ast.getChildren(idx);
+    shared_ptr<NFA> currNfa_ptr;
+    if (node.type == '|')
     {
-        shared_ptr<NFA> currNfa_ptr;
         nfa_ptr->unsetAccept();
-        for (auto pathSequence : ctx->pathSequence())
+        for (size_t i = 0; i < node.numChildren; i++)
         {
             currNfa_ptr = make_shared<NFA>();
-            visitPathSequence(pathSequence, currNfa_ptr);
+            convert(ast, childIdx[i], currNfa_ptr);
             // Attach transition from current initial to sub-initial (label eps)
             nfa_ptr->initial->addTransition(-1, true, currNfa_ptr->initial);
             for (auto acceptState : currNfa_ptr->accepts)
@@ -101,28 +87,12 @@ Rpq2NFAConvertor::visitPath(rpqParser::PathContext *ctx, shared_ptr<NFA> nfa_ptr
             nfa_ptr->addStates(currNfa_ptr->states);
         }
     }
-    return antlrcpp::Any();
-}
-
-/**
- * @brief pathSequence : pathEltOrInverse ( '/' pathEltOrInverse )* 
- * 
- * @param ctx pointer to pathSequence's context
- * @param nfa_ptr pointer to the NFA to be constructed
- * @return antlrcpp::Any a dummy antlrcpp::Any object
- */
-antlrcpp::Any
-Rpq2NFAConvertor::visitPathSequence(rpqParser::PathSequenceContext *ctx, std::shared_ptr<NFA> nfa_ptr)
-{
-    if ((ctx->pathElt()).size() == 1)
-        visitPathElt(ctx->pathElt(0), nfa_ptr);
-    else
+    else if (node.type == '/')
     {
-        shared_ptr<NFA> currNfa_ptr;
-        for (auto pathEltOrInverse : ctx->pathElt())
+        for (size_t i = 0; i < node.numChildren; i++)
         {
             currNfa_ptr = make_shared<NFA>();
-            visitPathElt(pathEltOrInverse, currNfa_ptr);
+            convert(ast, childIdx[i], currNfa_ptr);
             // Attach transition from current accepts to sub-initial (label eps)
             for (auto acceptState : nfa_ptr->accepts)
                 acceptState->addTransition(-1, true, currNfa_ptr->initial);
@@ -131,61 +101,126 @@ Rpq2NFAConvertor::visitPathSequence(rpqParser::PathSequenceContext *ctx, std::sh
             nfa_ptr->addStates(currNfa_ptr->states);
         }
     }
-    return antlrcpp::Any();
-}
-
-/**
- * @brief pathElt : pathPrimary pathMod? ;
- * 
- * @param ctx pointer to pathElt's context
- * @param nfa_ptr pointer to the NFA to be constructed
- * @return antlrcpp::Any a dummy antlrcpp::Any object
- */
-antlrcpp::Any
-Rpq2NFAConvertor::visitPathElt(rpqParser::PathEltContext *ctx,
-    std::shared_ptr<NFA> nfa_ptr)
-{
-    visitPathPrimary(ctx->pathPrimary(), nfa_ptr);
-    if (ctx->pathMod())
+    else if (node.type == 'l')
     {
-        string elt = ctx->pathMod()->getText();
-        if (elt == "*" || elt == "+") {
+        nfa_ptr->unsetAccept();
+        shared_ptr<State> newAccept = nfa_ptr->addState(true);
+        nfa_ptr->initial->addTransition(int(node.lbl), !node.inv, newAccept);
+        nfa_ptr->setAccept(newAccept);
+    }
+    else
+    {
+        convert(ast, childIdx[0], nfa_ptr);
+        if (node.type == '*' || node.type == '+') {
             // Backward edge of Kleene star
             for (auto acceptState : nfa_ptr->accepts)
                 acceptState->addTransition(-1, true, nfa_ptr->initial);
         }
-        if (elt != "+")
+        if (node.type != '+')
             nfa_ptr->setAccept(nfa_ptr->initial);    // Both ? and *
     }
-    return antlrcpp::Any();
+}
+
+shared_ptr<NFA> Rpq2NFAConvertor::convertGlushkov(const string &query)
+{
+    RpqAst ast;
+    ast.parse(query);
+    return convertGlushkov(ast, ast.getRoot());
 }
 
 /**
- * @brief pathPrimary : iri | '(' path ')' ;
- * iri : '[' num_integer '-'? ']' ;
+ * @brief Glushkov (position automaton) construction: one state per label occurrence plus the initial state, and
+ * a transition labeled by q's label from p to every position q that may follow p (from the initial state to every
+ * position a path may start with). Positions a path may end with accept, and so does the initial state if the
+ * query matches the empty path. Free of eps transitions, so no closures are needed to execute it.
  * 
- * @param ctx pointer to pathPrimary's context
- * @param nfa_ptr pointer to the NFA to be constructed
- * @return antlrcpp::Any a dummy antlrcpp::Any object
+ * @param ast the parsed query
+ * @param idx the node of the sub-expression in ast
+ * @return shared_ptr<NFA> pointer to the NFA
  */
-antlrcpp::Any
-Rpq2NFAConvertor::visitPathPrimary(rpqParser::PathPrimaryContext *ctx,
-    std::shared_ptr<NFA> nfa_ptr)
+shared_ptr<NFA> Rpq2NFAConvertor::convertGlushkov(RpqAst &ast, size_t idx)
 {
-    if (ctx->path())
-        visitPath(ctx->path(), nfa_ptr);
-    else if (ctx->iri())
-    {
-        int lbl_ = stoi(ctx->iri()->num_integer()->getText());
-        bool forward_ = true;
-        string iriStr = ctx->iri()->getText();
-        if (iriStr.length() > 2 && iriStr[iriStr.length() - 2] == '-')
-            forward_ = false;
-        
+    vector<size_t> posNode;
+    vector<vector<size_t>> follow;
+    GlushkovSets sets;
+    glushkov(ast, idx, posNode, follow, sets);
+
+    shared_ptr<NFA> nfa_ptr = make_shared<NFA>();
+    if (!sets.nullable)
         nfa_ptr->unsetAccept();
-        shared_ptr<State> newAccept = nfa_ptr->addState(true); // TODO: addState
-        nfa_ptr->initial->addTransition(lbl_, forward_, newAccept);
-        nfa_ptr->setAccept(newAccept);
+    size_t numPos = posNode.size();
+    vector<shared_ptr<State>> posState(numPos);
+    for (size_t p = 0; p < numPos; p++)
+        posState[p] = nfa_ptr->addState(false);
+    for (size_t p : sets.last)
+        nfa_ptr->setAccept(posState[p]);
+    auto addTransition = [&](const shared_ptr<State> &src, size_t q) {
+        const auto &lblNode = ast.getNodes()[posNode[q]];
+        src->addTransition(int(lblNode.lbl), !lblNode.inv, posState[q]);
+    };
+    for (size_t q : sets.first)
+        addTransition(nfa_ptr->initial, q);
+    for (size_t p = 0; p < numPos; p++) {
+        // Nested closures may add a position twice
+        sort(follow[p].begin(), follow[p].end());
+        follow[p].erase(unique(follow[p].begin(), follow[p].end()), follow[p].end());
+        for (size_t q : follow[p])
+            addTransition(posState[p], q);
+    }
+    return nfa_ptr;
+}
+
+void Rpq2NFAConvertor::glushkov(RpqAst &ast, size_t idx, std::vector<size_t> &posNode,
+    std::vector<std::vector<size_t>> &follow, GlushkovSets &ret)
+{
+    const auto &node = ast.getNodes()[idx];
+    const size_t *childIdx = ast.getChildren(idx);
+    if (node.type == 'l')
+    {
+        ret.nullable = false;
+        ret.first.assign(1, posNode.size());
+        ret.last = ret.first;
+        posNode.emplace_back(idx);
+        follow.emplace_back();
+        return;
+    }
+    GlushkovSets cur;
+    if (node.type == '|')
+    {
+        glushkov(ast, childIdx[0], posNode, follow, ret);
+        for (size_t i = 1; i < node.numChildren; i++)
+        {
+            glushkov(ast, childIdx[i], posNode, follow, cur);
+            ret.nullable = ret.nullable || cur.nullable;
+            ret.first.insert(ret.first.end(), cur.first.begin(), cur.first.end());
+            ret.last.insert(ret.last.end(), cur.last.begin(), cur.last.end());
+        }
     }
-    return antlrcpp::Any();
-}
\ No newline at end of file
+    else if (node.type == '/')
+    {
+        // ret holds the sets of the prefix so far
+        glushkov(ast, childIdx[0], posNode, follow, ret);
+        for (size_t i = 1; i < node.numChildren; i++)
+        {
+            glushkov(ast, childIdx[i], posNode, follow, cur);
+            for (size_t p : ret.last)
+                follow[p].insert(follow[p].end(), cur.first.begin(), cur.first.end());
+            if (ret.nullable)
+                ret.first.insert(ret.first.end(), cur.first.begin(), cur.first.end());
+            if (cur.nullable)
+                ret.last.insert(ret.last.end(), cur.last.begin(), cur.last.end());
+            else
+                ret.last.swap(cur.last);
+            ret.nullable = ret.nullable && cur.nullable;
+        }
+    }
+    else
+    {
+        glushkov(ast, childIdx[0], posNode, follow, ret);
+        if (node.type == '*' || node.type == '+')
+            for (size_t p : ret.last)
+                follow[p].insert(follow[p].end(), ret.first.begin(), ret.first.end());
+        if (node.type != '+')
+            ret.nullable = true;
+    }
+}
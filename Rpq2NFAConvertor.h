@@ -9,19 +9,26 @@
 
 #include "Util.h"
 #include "NFA.h"
+#include "RpqAst.h"
 
-class Rpq2NFAConvertor: public rpqBaseVisitor
+class Rpq2NFAConvertor
 {
 public:
     void getClauses(const std::string &query, std::vector<std::string> &v);
     std::shared_ptr<NFA> convert(const std::string &query);	// Overall driver function
-    antlrcpp::Any visitPath(rpqParser::PathContext *ctx, std::shared_ptr<NFA> nfa_ptr);
-    antlrcpp::Any visitPathSequence(rpqParser::PathSequenceContext *ctx,
-        std::shared_ptr<NFA> nfa_ptr);
-    antlrcpp::Any visitPathElt(rpqParser::PathEltContext *ctx,
-        std::shared_ptr<NFA> nfa_ptr);
-    antlrcpp::Any visitPathPrimary(rpqParser::PathPrimaryContext *ctx,
-        std::shared_ptr<NFA> nfa_ptr);
+    std::shared_ptr<NFA> convert(RpqAst &ast, size_t idx);   // NFA of the sub-expression of an already parsed query
+    // Eps-free position automaton, usable wherever convert(query)->convert2Dfa() is
+    std::shared_ptr<NFA> convertGlushkov(const std::string &query);
+    std::shared_ptr<NFA> convertGlushkov(RpqAst &ast, size_t idx);
 private:
-    void getClausesSinglePath(rpqParser::PathContext *path, std::vector<std::string> &v);
-};
\ No newline at end of file
+    // Of a sub-expression: whether it matches the empty path, and the positions (label occurrences) its paths
+    // may start and end with
+    struct GlushkovSets {
+        bool nullable;
+        std::vector<size_t> first, last;
+        GlushkovSets(): nullable(false) {}
+    };
+    void convert(RpqAst &ast, size_t idx, std::shared_ptr<NFA> nfa_ptr);
+    void glushkov(RpqAst &ast, size_t idx, std::vector<size_t> &posNode, std::vector<std::vector<size_t>> &follow,
+        GlushkovSets &ret);
+};
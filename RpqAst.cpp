@@ -0,0 +1,238 @@
+/**
+ * @file RpqAst.cpp
+ * @brief Implements methods in RpqAst.h
+ * @date 2024-04-15
+ */
+
+#include "RpqAst.h"
+using namespace std;
+
+size_t RpqAst::addNode(char type_, const size_t *childIdx, size_t numChildren) {
+    nodes.emplace_back(type_);
+    nodes.back().childBegin = childPool.size();
+    nodes.back().numChildren = numChildren;
+    childPool.insert(childPool.end(), childIdx, childIdx + numChildren);
+    text.emplace_back();
+    return nodes.size() - 1;
+}
+
+void RpqAst::parse(const std::string &q) {
+    nodes.clear();
+    childPool.clear();
+    scratch.clear();
+    text.clear();
+    begin = cur = q.data();
+    end = begin + q.size();
+    root = parsePath();
+    if (cur != end)
+        syntaxError("extraneous input '" + string(1, *cur) + "'");
+}
+
+void RpqAst::syntaxError(const std::string &msg) const {
+    throw std::runtime_error("[Syntax Error]:line 1:" + to_string(cur - begin) + " " + msg);
+}
+
+// The node of the group of the children on scratch from mark (the only child itself if one)
+size_t RpqAst::popGroup(char type_, size_t mark) {
+    size_t ret = scratch[mark];
+    if (scratch.size() - mark > 1)
+        ret = addNode(type_, scratch.data() + mark, scratch.size() - mark);
+    scratch.resize(mark);
+    return ret;
+}
+
+size_t RpqAst::parsePath() {
+    size_t mark = scratch.size();
+    scratch.emplace_back(parseSequence());
+    while (cur != end && *cur == '|') {
+        cur++;
+        scratch.emplace_back(parseSequence());
+    }
+    return popGroup('|', mark);
+}
+
+size_t RpqAst::parseSequence() {
+    size_t mark = scratch.size();
+    scratch.emplace_back(parseElt());
+    while (cur != end && *cur == '/') {
+        cur++;
+        scratch.emplace_back(parseElt());
+    }
+    return popGroup('/', mark);
+}
+
+size_t RpqAst::parseElt() {
+    size_t ret = 0;
+    if (cur == end)
+        syntaxError("missing '<' or '(' at <EOF>");
+    if (*cur == '(') {
+        cur++;
+        ret = parsePath();
+        if (cur == end || *cur != ')')
+            syntaxError("missing ')'");
+        cur++;
+    } else if (*cur == '<') {
+        cur++;
+        if (cur == end || *cur < '0' || *cur > '9')
+            syntaxError("missing INTEGER");
+        size_t lbl = 0;
+        for (; cur != end && *cur >= '0' && *cur <= '9'; cur++)
+            lbl = lbl * 10 + (*cur - '0');
+        bool inv = cur != end && *cur == '-';
+        if (inv)
+            cur++;
+        if (cur == end || *cur != '>')
+            syntaxError("missing '>'");
+        cur++;
+        ret = addNode('l');
+        nodes[ret].lbl = lbl;
+        nodes[ret].inv = inv;
+    } else
+        syntaxError("mismatched input '" + string(1, *cur) + "' expecting '<' or '('");
+    if (cur != end && (*cur == '*' || *cur == '+' || *cur == '?')) {
+        ret = addNode(*cur, &ret, 1);
+        cur++;
+    }
+    return ret;
+}
+
+/**
+ * @brief Rewrite the tree bottom-up: flatten nested groups of the same operator, sort and deduplicate the branches
+ * of alternations, collapse stacked modifiers ((a*)* and (a?)* to a*, and any two different ones to *), and turn
+ * X/X* and its mirror image into X+ (X may be a concatenation). Parentheses are printed only where the grammar
+ * needs them.
+ */
+void RpqAst::normalize() {
+    if (!nodes.empty())
+        root = normalize(root);
+}
+
+size_t RpqAst::normalize(size_t idx) {
+    char type = nodes[idx].type;
+    if (type == 'l')
+        return idx;
+    // Copy, as adding nodes may reallocate the pool
+    vector<size_t> childIdx(getChildren(idx), getChildren(idx) + nodes[idx].numChildren);
+    for (auto &c : childIdx)
+        c = normalize(c);
+    if (type == '|' || type == '/')
+        return makeNary(type, childIdx);
+    return makeModifier(type, childIdx[0]);
+}
+
+size_t RpqAst::makeModifier(char type_, size_t childIdx) {
+    char childType = nodes[childIdx].type;
+    if (childType == '*' || childType == '+' || childType == '?') {
+        if (childType == type_)
+            return childIdx;
+        return makeModifier('*', getChildren(childIdx)[0]);
+    }
+    return addNode(type_, &childIdx, 1);
+}
+
+size_t RpqAst::makeNary(char type_, std::vector<size_t> &childIdx) {
+    vector<size_t> flat;
+    for (size_t c : childIdx) {
+        if (nodes[c].type == type_)
+            flat.insert(flat.end(), getChildren(c), getChildren(c) + nodes[c].numChildren);
+        else
+            flat.emplace_back(c);
+    }
+    if (type_ == '|') {
+        sort(flat.begin(), flat.end(), [this](size_t a, size_t b) { return toString(a) < toString(b); });
+        flat.erase(unique(flat.begin(), flat.end(), [this](size_t a, size_t b) { return toString(a) == toString(b); }), flat.end());
+    } else {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = 0; i < flat.size() && !changed; i++) {
+                if (nodes[flat[i]].type != '*')
+                    continue;
+                size_t bodyIdx = getChildren(flat[i])[0];
+                vector<size_t> body;
+                if (nodes[bodyIdx].type == '/')
+                    body.assign(getChildren(bodyIdx), getChildren(bodyIdx) + nodes[bodyIdx].numChildren);
+                else
+                    body.emplace_back(bodyIdx);
+                size_t k = body.size();
+                auto matchesBody = [&](size_t from) {
+                    if (from + k > flat.size())
+                        return false;
+                    for (size_t j = 0; j < k; j++)
+                        if (toString(flat[from + j]) != toString(body[j]))
+                            return false;
+                    return true;
+                };
+                size_t from = 0;
+                if (i >= k && matchesBody(i - k))
+                    from = i - k;   // X/X*
+                else if (matchesBody(i + 1))
+                    from = i;   // X*/X
+                else
+                    continue;
+                size_t plusIdx = makeModifier('+', bodyIdx);
+                flat.erase(flat.begin() + from, flat.begin() + from + k + 1);
+                flat.insert(flat.begin() + from, plusIdx);
+                changed = true;
+            }
+        }
+    }
+    if (flat.size() == 1)
+        return flat[0];
+    return addNode(type_, flat.data(), flat.size());
+}
+
+const std::string &RpqAst::toString(size_t idx) {
+    if (!text[idx].empty())
+        return text[idx];
+    const auto &node = nodes[idx];
+    const size_t *childIdx = getChildren(idx);
+    string ret;
+    if (node.type == 'l')
+        ret = "<" + to_string(node.lbl) + (node.inv ? "->" : ">");
+    else if (node.type == '/')
+        ret = toString(childIdx, 0, node.numChildren - 1);
+    else if (node.type == '|') {
+        for (size_t i = 0; i < node.numChildren; i++) {
+            if (i > 0)
+                ret += '|';
+            size_t c = childIdx[i];
+            // A group of the same operator only occurs before normalization; keep it, as it is a different dag node
+            if (nodes[c].type == '|')
+                ret += "(" + toString(c) + ")";
+            else
+                ret += toString(c);
+        }
+    } else {
+        size_t c = childIdx[0];
+        if (nodes[c].type == 'l')
+            ret = toString(c);
+        else
+            ret = "(" + toString(c) + ")";
+        ret += node.type;
+    }
+    text[idx] = ret;
+    return text[idx];
+}
+
+// Text of the concatenation of the elements eltIdx[from..to]
+std::string RpqAst::toString(const size_t *eltIdx, size_t from, size_t to) {
+    string ret;
+    for (size_t i = from; i <= to; i++) {
+        if (i > from)
+            ret += '/';
+        size_t c = eltIdx[i];
+        if (nodes[c].type == '|' || nodes[c].type == '/')
+            ret += "(" + toString(c) + ")";
+        else
+            ret += toString(c);
+    }
+    return ret;
+}
+
+std::string RpqAst::normalize(const std::string &q) {
+    RpqAst ast;
+    ast.parse(q);
+    ast.normalize();
+    return ast.toString();
+}
@@ -0,0 +1,59 @@
+/**
+ * @file RpqAst.h
+ * @brief Syntax tree of an RPQ, parsed by hand and normalized so that equivalent spellings of a query get the same text
+ * @date 2024-04-15
+ */
+
+#pragma once
+#include "Util.h"
+
+struct RpqAstNode {
+    char type;  // Label 'l', alternation '|', concat '/', or the modifier '*', '+', '?'
+    bool inv;
+    size_t lbl; // For labels
+    size_t childBegin, numChildren; // The children are RpqAst::childPool[childBegin, childBegin + numChildren)
+    RpqAstNode(char type_): type(type_), inv(false), lbl(0), childBegin(0), numChildren(0) {}
+};
+
+/**
+ * @brief Nodes live in one arena and are never removed: rewriting adds nodes and moves the root, and the
+ * text of each node is memoized, so sub-expressions are compared and sorted by their (normalized) text.
+ * The child lists of all nodes share one pool, and parsing again reuses the capacity of both, so an RpqAst
+ * kept around parses without allocating once it has seen a query as large.
+ *
+ * Grammar (see parser/rpq.g4; no whitespace):
+ * path : pathSequence ( '|' pathSequence )* ;
+ * pathSequence : pathElt ( '/' pathElt )* ;
+ * pathElt : pathPrimary ( '?' | '*' | '+' )? ;
+ * pathPrimary : '<' INTEGER '-'? '>' | '(' path ')' ;
+ */
+class RpqAst {
+    std::vector<RpqAstNode> nodes;
+    std::vector<size_t> childPool;
+    std::vector<size_t> scratch;    // Children of the groups being parsed
+    std::vector<std::string> text;  // Memoized toString of each node ("" until computed)
+    size_t root;
+    const char *begin, *cur, *end;  // The query being parsed
+
+    size_t addNode(char type_, const size_t *childIdx=nullptr, size_t numChildren=0);
+    size_t parsePath();
+    size_t parseSequence();
+    size_t parseElt();
+    size_t popGroup(char type_, size_t mark);
+    [[noreturn]] void syntaxError(const std::string &msg) const;
+    size_t normalize(size_t idx);
+    size_t makeModifier(char type_, size_t childIdx);
+    size_t makeNary(char type_, std::vector<size_t> &childIdx);
+public:
+    RpqAst(): root(0), begin(nullptr), cur(nullptr), end(nullptr) {}
+    void parse(const std::string &q);   // Throws std::runtime_error on syntax errors
+    void normalize();
+    const std::string &toString(size_t idx);
+    const std::string &toString() { return toString(root); }
+    std::string toString(const size_t *eltIdx, size_t from, size_t to);  // Concat of eltIdx[from..to]
+    const std::vector<RpqAstNode> &getNodes() const { return nodes; }
+    const size_t *getChildren(size_t idx) const { return childPool.data() + nodes[idx].childBegin; }
+    size_t getRoot() const { return root; }
+
+    static std::string normalize(const std::string &q); // Normalized text of q
+};
@@ -1,11 +1,56 @@
 #include "Util.h"
 
+static std::atomic<unsigned> rngSeed(5489u), rngEpoch(0), rngThreadCnt(0);
+
 /**
-	Throw a runtime error when lexical and syntactic errors are detected in the query.
+	Per-thread Mersenne Twister; thread-safe replacement of rand(). Reseeded lazily after setRngSeed.
 */
-void RpqErrorListener::syntaxError(antlr4::Recognizer *recognizer, antlr4::Token * offendingSymbol, \
-	size_t line, size_t charPositionInLine, const std::string &msg, std::exception_ptr e)
+std::mt19937 &getThreadRng()
+{
+	thread_local std::mt19937 rng;
+	thread_local unsigned threadId = rngThreadCnt++, seededEpoch = UINT_MAX;
+	unsigned curEpoch = rngEpoch.load();
+	if (seededEpoch != curEpoch) {
+		rng.seed(rngSeed.load() + threadId * 0x9E3779B9u);
+		seededEpoch = curEpoch;
+	}
+	return rng;
+}
+
+void setRngSeed(unsigned seed)
+{
+	rngSeed = seed;
+	rngEpoch++;
+}
+
+/**
+	Floyd's algorithm: O(k) expected time regardless of n. If k >= n, all of [0, n) are returned.
+	The indices are shuffled, so every prefix of the result is also a uniform sample.
+*/
+void sampleWithoutReplacement(size_t n, size_t k, std::vector<size_t> &sampled)
+{
+	sampled.clear();
+	if (k >= n) {
+		for (size_t i = 0; i < n; i++)
+			sampled.emplace_back(i);
+		return;
+	}
+	std::mt19937 &rng = getThreadRng();
+	std::unordered_set<size_t> chosen;
+	for (size_t j = n - k; j < n; j++) {
+		size_t t = std::uniform_int_distribution<size_t>(0, j)(rng);
+		if (!chosen.emplace(t).second)
+			t = j;
+		chosen.emplace(t);
+		sampled.emplace_back(t);
+	}
+	std::shuffle(sampled.begin(), sampled.end(), rng);
+}
+
+size_t IdSeqHash::operator()(const std::vector<size_t> &v) const
 {
-	throw std::runtime_error("[Syntax Error]:line " + std::to_string(line) + ":" \
-        + std::to_string(charPositionInLine) + " " + msg);
-}
\ No newline at end of file
+	size_t h = v.size();
+	for (size_t x : v)
+		h ^= std::hash<size_t>()(x) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+	return h;
+}
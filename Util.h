@@ -15,20 +15,22 @@
 #include <sstream>
 #include <iostream>
 #include <chrono>
+#include <atomic>
+#include <climits>
+#include <mutex>
+#include <memory>
+#include <map>
+#include <stack>
+#include <limits>
+#include <cassert>
 #include "string.h"
-#include "antlr4-runtime.h"
-#include "parser/rpqLexer.h"
-#include "parser/rpqParser.h"
-#include "parser/rpqBaseVisitor.h"
 #include "omp.h"
 
-/**
-	Listener for errors during SPARQL query parsing, which throws a 
-	corresponding exception when an error arises.
-*/
-class RpqErrorListener: public antlr4::BaseErrorListener
-{
-public:
-	void syntaxError(antlr4::Recognizer *recognizer, antlr4::Token * offendingSymbol, \
-		size_t line, size_t charPositionInLine, const std::string &msg, std::exception_ptr e);
-};
\ No newline at end of file
+std::mt19937 &getThreadRng();   // Per-thread random engine, seeded from the seed set by setRngSeed
+void setRngSeed(unsigned seed); // Reseed the engines of all threads (each thread derives its own stream)
+void sampleWithoutReplacement(size_t n, size_t k, std::vector<size_t> &sampled); // k distinct indices in [0, n), random order
+
+// Hash of a sequence of ids, e.g., an (operator, operand ids) tuple to intern
+struct IdSeqHash {
+    size_t operator()(const std::vector<size_t> &v) const;
+};
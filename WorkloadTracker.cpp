@@ -0,0 +1,21 @@
+/**
+ * @file WorkloadTracker.cpp
+ * @brief Implements methods in WorkloadTracker.h
+ * @date 2024-04-08
+ */
+
+#include "WorkloadTracker.h"
+using namespace std;
+
+void WorkloadTracker::record(const std::string &q) {
+    if (q.empty())
+        return;
+    window.emplace_back(q);
+    q2freq[q]++;
+    if (window.size() > windowSz) {
+        auto it = q2freq.find(window.front());
+        if (--it->second == 0)
+            q2freq.erase(it);
+        window.pop_front();
+    }
+}
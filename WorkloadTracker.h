@@ -0,0 +1,26 @@
+/**
+ * @file WorkloadTracker.h
+ * @brief Sliding-window frequencies of the recently issued queries
+ * @date 2024-04-08
+ */
+
+#pragma once
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Counts the queries among the last windowSz recorded ones, so that view selection follows
+ * the current query mix instead of a fixed workload file.
+ */
+class WorkloadTracker {
+    size_t windowSz;
+    std::deque<std::string> window; // Recorded queries, oldest first
+    std::unordered_map<std::string, size_t> q2freq; // Frequency of each query in the window
+public:
+    WorkloadTracker(size_t windowSz_): windowSz(windowSz_ > 0 ? windowSz_ : 1) {}
+    void record(const std::string &q);  // Append q, evicting the oldest query if the window is full
+    const std::unordered_map<std::string, size_t> &getQ2freq() const { return q2freq; }
+    size_t size() const { return window.size(); }
+    size_t getWindowSz() const { return windowSz; }
+};
@@ -20,7 +20,7 @@ int main(int argc, char **argv) {
         lseq = spo;
     auto start_time = std::chrono::steady_clock::now();
     csrPtr->loadGraph(graphFilePath, lseq);
-    // csrPtr->fillStats();
+    csrPtr->loadOrFillStats(graphFilePath + ".stats");
     auto end_time = std::chrono::steady_clock::now();
     std::chrono::microseconds elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
     std::cout << "Read graph time: " << elapsed_microseconds.count() / 1000.0 << " ms" << std::endl;
@@ -6,6 +6,7 @@
  */
 
 #include "AndOrDag.h"
+#include "OnlineViewManager.h"
 using namespace std;
 
 int main(int argc, char **argv) {
@@ -18,7 +19,9 @@ int main(int argc, char **argv) {
     unordered_map<string, size_t> q2freq;
     unordered_map<string, size_t>::iterator it;
     string line, q;
+    vector<string> qSeq;    // Queries in the order issued, replayed by the online mode
     while (fin >> q) {
+        qSeq.emplace_back(q);
         it = q2freq.find(q);
         if (it == q2freq.end())
             q2freq[q] = 1;
@@ -27,10 +30,21 @@ int main(int argc, char **argv) {
     }
     size_t numModes = 5;
     size_t usedSpace = 0, budget = 1000000;
-    bool execute = false;
-    if (argc == 2 && (strcmp(argv[1], "-e") == 0 || strcmp(argv[1], "--execute") == 0)) {
-        cout << "Execute mode." << endl;
-        execute = true;
+    bool execute = false, lcr = false, greedy = false, online = false, match = false, normalize = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--execute") == 0) {
+            cout << "Execute mode." << endl;
+            execute = true;
+        } else if (strcmp(argv[i], "--lcr") == 0)
+            lcr = true; // Closures over label sets in the workload become LCR index candidates
+        else if (strcmp(argv[i], "--greedy") == 0)
+            greedy = true;  // Time greedy selection replanning stale candidates one at a time vs. in parallel batches
+        else if (strcmp(argv[i], "--online") == 0)
+            online = true;  // Replay the queries with views re-selected over a sliding window in the background
+        else if (strcmp(argv[i], "--match") == 0)
+            match = true;   // Views also answer equivalent queries (e.g., <1>* from <1>+)
+        else if (strcmp(argv[i], "--normalize") == 0)
+            normalize = true;   // Merge the spellings of a query (e.g., <2>|<1> and (<1>|<2>)) when building the dag
     }
     // QueryResult qr(nullptr, false);
     float naiveTime = 0;
@@ -44,13 +58,35 @@ int main(int argc, char **argv) {
         lseq = spo;
     auto start_time = std::chrono::steady_clock::now();
     csrPtr->loadGraph(graphFilePath, lseq);
-    // csrPtr->fillStats();
+    csrPtr->loadOrFillStats(graphFilePath + ".stats");
     auto end_time = std::chrono::steady_clock::now();
     std::chrono::microseconds elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
     std::cout << "Read graph time: " << elapsed_microseconds.count() / 1000.0 << " ms" << std::endl;
     
+    if (online) {
+        size_t windowSz = max(qSeq.size() / 10, size_t(1));
+        OnlineViewManager mgr(csrPtr, windowSz, budget, windowSz);
+        float onlineTime = 0;
+        for (const auto &curQ : qSeq) {
+            QueryResult qr(nullptr, false);
+            start_time = std::chrono::steady_clock::now();
+            auto snapshotPtr = mgr.execute(curQ, qr);
+            end_time = std::chrono::steady_clock::now();
+            elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            onlineTime += elapsed_microseconds.count();
+            if (qr.newed)
+                delete qr.csrPtr;
+        }
+        mgr.waitReselect();
+        std::cout << "Online execution time: " << onlineTime << " us" << std::endl;
+        std::cout << "Last re-selection added/kept/dropped views: " << mgr.getNumAdded() << "/" << mgr.getNumKept()
+            << "/" << mgr.getNumDropped() << std::endl;
+    }
+
     // Construct DAG and plan
     AndOrDag aod(csrPtr);
+    aod.setUseViewMatch(match);
+    aod.setNormalizeQueries(normalize);
     for (const auto &p: q2freq)
         aod.addWorkloadQuery(p.first, p.second);
     aod.initAuxiliary();
@@ -60,6 +96,8 @@ int main(int argc, char **argv) {
     end_time = std::chrono::steady_clock::now();
     elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
     std::cout << "Plan time: " << elapsed_microseconds.count() / 1000.0 << " ms" << std::endl;
+    if (lcr)
+        std::cout << "LCR label sets: " << aod.addLcrLabelSetsFromWorkload() << std::endl;
     if (execute) {
         for (const auto &p: q2freq) {
             QueryResult qr(nullptr, false);
@@ -75,6 +113,20 @@ int main(int argc, char **argv) {
     }
     std::cout << "Naive execution time: " << naiveTime << " us" << std::endl;
 
+    if (greedy) {
+        for (size_t batch : {size_t(1), size_t(REPLANBATCH)}) {
+            AndOrDag tmpAod(aod);
+            tmpAod.setReplanBatch(batch);
+            size_t greedySpace = 0;
+            start_time = std::chrono::steady_clock::now();
+            float greedyCostReduction = tmpAod.chooseMatViews(0, greedySpace, budget);
+            end_time = std::chrono::steady_clock::now();
+            elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+            std::cout << "Greedy (replan batch " << batch << ") time: " << elapsed_microseconds.count() << " us, cost reduction "
+                << (unsigned long long)(greedyCostReduction) << ", used space " << greedySpace << std::endl;
+        }
+    }
+
     // Choose materialized views
     float curCostReduction = 0;
     vector<size_t> modesVec({5});
@@ -86,6 +138,7 @@ int main(int argc, char **argv) {
         end_time = std::chrono::steady_clock::now();
         elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
         std::cout << "Choose materialized views time: " << elapsed_microseconds.count() << " us" << std::endl;
+        std::cout << "Estimate cache hit/miss: " << tmpAod.getEstimateCacheHit() << "/" << tmpAod.getEstimateCacheMiss() << std::endl;
         // For each selection method, get the overall cost reduction; print the selected views and the cost reduction
         cout << i << " " << (unsigned long long)(curCostReduction) << " " << usedSpace << endl;
         const auto &q2idx = tmpAod.getQ2idx();
@@ -103,6 +156,7 @@ int main(int argc, char **argv) {
             end_time = std::chrono::steady_clock::now();
             elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
             std::cout << "Materialize views time: " << elapsed_microseconds.count() << " us" << std::endl;
+            std::cout << "Real used space: " << tmpAod.getRealUsedSpace() << std::endl;
             for (const auto &p: q2freq) {
                 QueryResult qr(nullptr, false);
                 start_time = std::chrono::steady_clock::now();
@@ -60,7 +60,7 @@ int main(int argc, char **argv) {
         lseq = spo;
     auto start_time = std::chrono::steady_clock::now();
     csrPtr->loadGraph(graphFilePath, lseq);
-    // csrPtr->fillStats();
+    csrPtr->loadOrFillStats(graphFilePath + ".stats");
     auto end_time = std::chrono::steady_clock::now();
     std::chrono::microseconds elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
     std::cout << "Read graph time: " << elapsed_microseconds.count() / 1000.0 << " ms" << std::endl;
@@ -142,16 +142,19 @@ int main(int argc, char **argv) {
                     qVec.emplace_back(q);
             }
         }
+        ReplanWorkspace replanWs;
         for (const auto &curQ : qVec) {
             cout << curQ << endl;
             it = aod.getQ2idx().find(curQ);
             if (it == aod.getQ2idx().end())
                 continue;
             size_t curIdx = it->second;
-            unordered_map<size_t, float> node2cost;
-            float reducedCost = 0;
+            ReplanResult replanRes;
             start_time = std::chrono::steady_clock::now();
-            aod.replanWithMaterialize({curIdx}, node2cost, reducedCost);
+            aod.replan({curIdx}, replanWs, replanRes);
+            // Execute the new view with the Kleene modes under it; the costs stay those of the plan
+            for (const auto &pr : replanRes.left2right)
+                aod.getNodes()[pr.first].setLeft2Right(pr.second);
             aod.executeNode(curIdx, aod.getNodes()[curIdx].getRes(), nullptr, nullptr, nullptr, curIdx);
             end_time = std::chrono::steady_clock::now();
             elapsed_microseconds = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
@@ -1,8 +1,6 @@
 grammar rpq;
 
-// export CLASSPATH="PATH-TO-antlr-4.7.2-complete.jar:$CLASSPATH"
-// alias antlr4='java -Xmx500M -cp "PATH-TO-antlr-4.7.2-complete.jar:$CLASSPATH" org.antlr.v4.Tool'
-// antlr4 -Dlanguage=Cpp ./SPARQL.g4 -visitor
+// Reference grammar of RPQs; parsed by the recursive-descent parser in RpqAst.cpp
 
 // Parser rules
 
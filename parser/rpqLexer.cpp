@@ -1,149 +0,0 @@
-
-// Generated from ./rpq.g4 by ANTLR 4.7.2
-
-
-#include "rpqLexer.h"
-
-
-using namespace antlr4;
-
-
-rpqLexer::rpqLexer(CharStream *input) : Lexer(input) {
-  _interpreter = new atn::LexerATNSimulator(this, _atn, _decisionToDFA, _sharedContextCache);
-}
-
-rpqLexer::~rpqLexer() {
-  delete _interpreter;
-}
-
-std::string rpqLexer::getGrammarFileName() const {
-  return "rpq.g4";
-}
-
-const std::vector<std::string>& rpqLexer::getRuleNames() const {
-  return _ruleNames;
-}
-
-const std::vector<std::string>& rpqLexer::getChannelNames() const {
-  return _channelNames;
-}
-
-const std::vector<std::string>& rpqLexer::getModeNames() const {
-  return _modeNames;
-}
-
-const std::vector<std::string>& rpqLexer::getTokenNames() const {
-  return _tokenNames;
-}
-
-dfa::Vocabulary& rpqLexer::getVocabulary() const {
-  return _vocabulary;
-}
-
-const std::vector<uint16_t> rpqLexer::getSerializedATN() const {
-  return _serializedATN;
-}
-
-const atn::ATN& rpqLexer::getATN() const {
-  return _atn;
-}
-
-
-
-
-// Static vars and initialization.
-std::vector<dfa::DFA> rpqLexer::_decisionToDFA;
-atn::PredictionContextCache rpqLexer::_sharedContextCache;
-
-// We own the ATN which in turn owns the ATN states.
-atn::ATN rpqLexer::_atn;
-std::vector<uint16_t> rpqLexer::_serializedATN;
-
-std::vector<std::string> rpqLexer::_ruleNames = {
-  u8"T__0", u8"T__1", u8"T__2", u8"T__3", u8"T__4", u8"T__5", u8"T__6", 
-  u8"T__7", u8"T__8", u8"T__9", u8"INTEGER"
-};
-
-std::vector<std::string> rpqLexer::_channelNames = {
-  "DEFAULT_TOKEN_CHANNEL", "HIDDEN"
-};
-
-std::vector<std::string> rpqLexer::_modeNames = {
-  u8"DEFAULT_MODE"
-};
-
-std::vector<std::string> rpqLexer::_literalNames = {
-  "", u8"'|'", u8"'/'", u8"'?'", u8"'*'", u8"'+'", u8"'('", u8"')'", u8"'<'", 
-  u8"'-'", u8"'>'"
-};
-
-std::vector<std::string> rpqLexer::_symbolicNames = {
-  "", "", "", "", "", "", "", "", "", "", "", u8"INTEGER"
-};
-
-dfa::Vocabulary rpqLexer::_vocabulary(_literalNames, _symbolicNames);
-
-std::vector<std::string> rpqLexer::_tokenNames;
-
-rpqLexer::Initializer::Initializer() {
-  // This code could be in a static initializer lambda, but VS doesn't allow access to private class members from there.
-	for (size_t i = 0; i < _symbolicNames.size(); ++i) {
-		std::string name = _vocabulary.getLiteralName(i);
-		if (name.empty()) {
-			name = _vocabulary.getSymbolicName(i);
-		}
-
-		if (name.empty()) {
-			_tokenNames.push_back("<INVALID>");
-		} else {
-      _tokenNames.push_back(name);
-    }
-	}
-
-  _serializedATN = {
-    0x3, 0x608b, 0xa72a, 0x8133, 0xb9ed, 0x417c, 0x3be7, 0x7786, 0x5964, 
-    0x2, 0xd, 0x32, 0x8, 0x1, 0x4, 0x2, 0x9, 0x2, 0x4, 0x3, 0x9, 0x3, 0x4, 
-    0x4, 0x9, 0x4, 0x4, 0x5, 0x9, 0x5, 0x4, 0x6, 0x9, 0x6, 0x4, 0x7, 0x9, 
-    0x7, 0x4, 0x8, 0x9, 0x8, 0x4, 0x9, 0x9, 0x9, 0x4, 0xa, 0x9, 0xa, 0x4, 
-    0xb, 0x9, 0xb, 0x4, 0xc, 0x9, 0xc, 0x3, 0x2, 0x3, 0x2, 0x3, 0x3, 0x3, 
-    0x3, 0x3, 0x4, 0x3, 0x4, 0x3, 0x5, 0x3, 0x5, 0x3, 0x6, 0x3, 0x6, 0x3, 
-    0x7, 0x3, 0x7, 0x3, 0x8, 0x3, 0x8, 0x3, 0x9, 0x3, 0x9, 0x3, 0xa, 0x3, 
-    0xa, 0x3, 0xb, 0x3, 0xb, 0x3, 0xc, 0x6, 0xc, 0x2f, 0xa, 0xc, 0xd, 0xc, 
-    0xe, 0xc, 0x30, 0x2, 0x2, 0xd, 0x3, 0x3, 0x5, 0x4, 0x7, 0x5, 0x9, 0x6, 
-    0xb, 0x7, 0xd, 0x8, 0xf, 0x9, 0x11, 0xa, 0x13, 0xb, 0x15, 0xc, 0x17, 
-    0xd, 0x3, 0x2, 0x3, 0x3, 0x2, 0x32, 0x3b, 0x2, 0x32, 0x2, 0x3, 0x3, 
-    0x2, 0x2, 0x2, 0x2, 0x5, 0x3, 0x2, 0x2, 0x2, 0x2, 0x7, 0x3, 0x2, 0x2, 
-    0x2, 0x2, 0x9, 0x3, 0x2, 0x2, 0x2, 0x2, 0xb, 0x3, 0x2, 0x2, 0x2, 0x2, 
-    0xd, 0x3, 0x2, 0x2, 0x2, 0x2, 0xf, 0x3, 0x2, 0x2, 0x2, 0x2, 0x11, 0x3, 
-    0x2, 0x2, 0x2, 0x2, 0x13, 0x3, 0x2, 0x2, 0x2, 0x2, 0x15, 0x3, 0x2, 0x2, 
-    0x2, 0x2, 0x17, 0x3, 0x2, 0x2, 0x2, 0x3, 0x19, 0x3, 0x2, 0x2, 0x2, 0x5, 
-    0x1b, 0x3, 0x2, 0x2, 0x2, 0x7, 0x1d, 0x3, 0x2, 0x2, 0x2, 0x9, 0x1f, 
-    0x3, 0x2, 0x2, 0x2, 0xb, 0x21, 0x3, 0x2, 0x2, 0x2, 0xd, 0x23, 0x3, 0x2, 
-    0x2, 0x2, 0xf, 0x25, 0x3, 0x2, 0x2, 0x2, 0x11, 0x27, 0x3, 0x2, 0x2, 
-    0x2, 0x13, 0x29, 0x3, 0x2, 0x2, 0x2, 0x15, 0x2b, 0x3, 0x2, 0x2, 0x2, 
-    0x17, 0x2e, 0x3, 0x2, 0x2, 0x2, 0x19, 0x1a, 0x7, 0x7e, 0x2, 0x2, 0x1a, 
-    0x4, 0x3, 0x2, 0x2, 0x2, 0x1b, 0x1c, 0x7, 0x31, 0x2, 0x2, 0x1c, 0x6, 
-    0x3, 0x2, 0x2, 0x2, 0x1d, 0x1e, 0x7, 0x41, 0x2, 0x2, 0x1e, 0x8, 0x3, 
-    0x2, 0x2, 0x2, 0x1f, 0x20, 0x7, 0x2c, 0x2, 0x2, 0x20, 0xa, 0x3, 0x2, 
-    0x2, 0x2, 0x21, 0x22, 0x7, 0x2d, 0x2, 0x2, 0x22, 0xc, 0x3, 0x2, 0x2, 
-    0x2, 0x23, 0x24, 0x7, 0x2a, 0x2, 0x2, 0x24, 0xe, 0x3, 0x2, 0x2, 0x2, 
-    0x25, 0x26, 0x7, 0x2b, 0x2, 0x2, 0x26, 0x10, 0x3, 0x2, 0x2, 0x2, 0x27, 
-    0x28, 0x7, 0x3e, 0x2, 0x2, 0x28, 0x12, 0x3, 0x2, 0x2, 0x2, 0x29, 0x2a, 
-    0x7, 0x2f, 0x2, 0x2, 0x2a, 0x14, 0x3, 0x2, 0x2, 0x2, 0x2b, 0x2c, 0x7, 
-    0x40, 0x2, 0x2, 0x2c, 0x16, 0x3, 0x2, 0x2, 0x2, 0x2d, 0x2f, 0x9, 0x2, 
-    0x2, 0x2, 0x2e, 0x2d, 0x3, 0x2, 0x2, 0x2, 0x2f, 0x30, 0x3, 0x2, 0x2, 
-    0x2, 0x30, 0x2e, 0x3, 0x2, 0x2, 0x2, 0x30, 0x31, 0x3, 0x2, 0x2, 0x2, 
-    0x31, 0x18, 0x3, 0x2, 0x2, 0x2, 0x4, 0x2, 0x30, 0x2, 
-  };
-
-  atn::ATNDeserializer deserializer;
-  _atn = deserializer.deserialize(_serializedATN);
-
-  size_t count = _atn.getNumberOfDecisions();
-  _decisionToDFA.reserve(count);
-  for (size_t i = 0; i < count; i++) { 
-    _decisionToDFA.emplace_back(_atn.getDecisionState(i), i);
-  }
-}
-
-rpqLexer::Initializer rpqLexer::_init;
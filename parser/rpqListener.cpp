@@ -1,7 +0,0 @@
-
-// Generated from ./rpq.g4 by ANTLR 4.7.2
-
-
-#include "rpqListener.h"
-
-
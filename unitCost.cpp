@@ -8,16 +8,26 @@
 #include <omp.h>
 #include "CSR.h"
 #include "Rpq2NFAConvertor.h"
+#include "AutomatonCache.h"
 #define MAXTHREAD 4
 #define MAXKLEENESTEP 6
 #define SAMPLESZ 100
 
 using namespace std;
 
+// Elements of the concatenation at idx (idx itself if not a concatenation), as text
+void getPathElts(RpqAst &ast, size_t idx, vector<string> &pathElts) {
+    pathElts.clear();
+    if (ast.getNodes()[idx].type == '/') {
+        for (size_t i = 0; i < ast.getNodes()[idx].numChildren; i++)
+            pathElts.emplace_back(ast.toString(ast.getChildren(idx), i, i));
+    } else
+        pathElts.emplace_back(ast.toString(&idx, 0, 0));
+}
+
 // Estimate the cost of pathElt[lIdx:rIdx]
-double estimateCost(rpqParser::PathContext *path, size_t lIdx, size_t rIdx, std::shared_ptr<MultiLabelCSR> csrPtr) {
+double estimateCost(const vector<string> &pathElts, size_t lIdx, size_t rIdx, std::shared_ptr<MultiLabelCSR> csrPtr) {
     double ret = 0, curCoefficient = 1;
-    rpqParser::PathSequenceContext *pathSequence = path->pathSequence()[0];
     double delta = 0, ksai = 0, prevMu = 0;
     bool inverse = false, nextInverse = false, kleene = false, nextKleene = false;
     size_t label = 0, nextLabel = 0, labelIdx = 0, nextLabelIdx = 0, lPos = 0, rPos = 0;
@@ -26,7 +36,7 @@ double estimateCost(rpqParser::PathContext *path, size_t lIdx, size_t rIdx, std:
     for (size_t i = lIdx; i < rIdx; i++) {
         // Transition from next to cur
         if (i == lIdx) {
-            pathEltStr = pathSequence->pathElt()[i]->getText();
+            pathEltStr = pathElts[i];
             lPos = pathEltStr.find('<');
             rPos = pathEltStr.find('>');
             inverse = (pathEltStr[rPos - 1] == '-');
@@ -54,7 +64,7 @@ double estimateCost(rpqParser::PathContext *path, size_t lIdx, size_t rIdx, std:
         else
             lblCsrPtr = &(csrPtr->outCsr[labelIdx]);    // sources of the current label
         size_t numNodes = lblCsrPtr->n;
-        unordered_map<unsigned, unsigned>::const_iterator v2idxIt;
+        vector<size_t> sampleIdx;
         double curMu = 0, kleeneMu = 0; // Only estimate kleeneMu if kleene == true
         if (kleene) {
             if (SAMPLESZ >= numNodes) {
@@ -84,11 +94,9 @@ double estimateCost(rpqParser::PathContext *path, size_t lIdx, size_t rIdx, std:
             } else {
                 // Do sampling
                 if (!inverse) {
-                    for (size_t k = 0; k < SAMPLESZ; k++) {
-                        size_t curIdx = rand() % numNodes;
-                        v2idxIt = lblCsrPtr->v2idx.begin();
-                        std::advance(v2idxIt, curIdx);
-                        size_t v = v2idxIt->first;
+                    sampleWithoutReplacement(numNodes, SAMPLESZ, sampleIdx);
+                    for (size_t curIdx : sampleIdx) {
+                        size_t v = lblCsrPtr->idx2v[curIdx];
                         for (size_t j = 0; j < numOutLabel; j++) {
                             tmpLblCsrPtr = &(csrPtr->outCsr[j]);
                             tmpLblCsrPtr->getAdjIntervalByVert(v, aitv);
@@ -97,11 +105,9 @@ double estimateCost(rpqParser::PathContext *path, size_t lIdx, size_t rIdx, std:
                         }
                     }
                 } else {
-                    for (size_t k = 0; k < SAMPLESZ; k++) {
-                        size_t curIdx = rand() % numNodes;
-                        v2idxIt = lblCsrPtr->v2idx.begin();
-                        std::advance(v2idxIt, curIdx);
-                        size_t v = v2idxIt->first;
+                    sampleWithoutReplacement(numNodes, SAMPLESZ, sampleIdx);
+                    for (size_t curIdx : sampleIdx) {
+                        size_t v = lblCsrPtr->idx2v[curIdx];
                         for (size_t j = 0; j < numOutLabel; j++) {
                             tmpLblCsrPtr = &(csrPtr->inCsr[j]);
                             tmpLblCsrPtr->getAdjIntervalByVert(v, aitv);
@@ -127,7 +133,7 @@ double estimateCost(rpqParser::PathContext *path, size_t lIdx, size_t rIdx, std:
         }
 
         if (i < rIdx - 1) {
-            pathEltStr = pathSequence->pathElt()[i+1]->getText();
+            pathEltStr = pathElts[i+1];
             lPos = pathEltStr.find('<');
             rPos = pathEltStr.find('>');
             nextInverse = (pathEltStr[rPos - 1] == '-');
@@ -173,11 +179,9 @@ double estimateCost(rpqParser::PathContext *path, size_t lIdx, size_t rIdx, std:
         } else {
             // Do sampling
             if (!nextInverse) {
-                for (size_t k = 0; k < SAMPLESZ; k++) {
-                    size_t curIdx = rand() % numNodes;
-                    v2idxIt = lblCsrPtr->v2idx.begin();
-                    std::advance(v2idxIt, curIdx);
-                    size_t v = v2idxIt->first;
+                sampleWithoutReplacement(numNodes, SAMPLESZ, sampleIdx);
+                for (size_t curIdx : sampleIdx) {
+                    size_t v = lblCsrPtr->idx2v[curIdx];
                     for (size_t j = 0; j < numOutLabel; j++) {
                         tmpLblCsrPtr = &(csrPtr->outCsr[j]);
                         tmpLblCsrPtr->getAdjIntervalByVert(v, aitv);
@@ -187,11 +191,9 @@ double estimateCost(rpqParser::PathContext *path, size_t lIdx, size_t rIdx, std:
                     }
                 }
             } else {
-                for (size_t k = 0; k < SAMPLESZ; k++) {
-                    size_t curIdx = rand() % numNodes;
-                    v2idxIt = lblCsrPtr->v2idx.begin();
-                    std::advance(v2idxIt, curIdx);
-                    size_t v = v2idxIt->first;
+                sampleWithoutReplacement(numNodes, SAMPLESZ, sampleIdx);
+                for (size_t curIdx : sampleIdx) {
+                    size_t v = lblCsrPtr->idx2v[curIdx];
                     for (size_t j = 0; j < numOutLabel; j++) {
                         tmpLblCsrPtr = &(csrPtr->inCsr[j]);
                         tmpLblCsrPtr->getAdjIntervalByVert(v, aitv);
@@ -225,9 +227,8 @@ double estimateCost(rpqParser::PathContext *path, size_t lIdx, size_t rIdx, std:
     return ret;
 }
 
-void getBestSplit(rpqParser::PathContext *path, vector<string> &splitParts, std::shared_ptr<MultiLabelCSR> csrPtr) {
-    rpqParser::PathSequenceContext *pathSequence = path->pathSequence()[0];
-    size_t maxThreadNum = pathSequence->pathElt().size() - 1;
+void getBestSplit(const vector<string> &pathElts, vector<string> &splitParts, std::shared_ptr<MultiLabelCSR> csrPtr) {
+    size_t maxThreadNum = pathElts.size() - 1;
     if (maxThreadNum > MAXTHREAD) maxThreadNum = MAXTHREAD;
     // Note: there are many opportunities for shared computation here, but we do not implement them for simplicity
     vector<string> curSplitParts;
@@ -241,20 +242,20 @@ void getBestSplit(rpqParser::PathContext *path, vector<string> &splitParts, std:
             double localMaxCost = 0;
             for (size_t i = 0; i < curThreadNum; i++) {
                 size_t lIdx = i == 0 ? 0 : splitPoints[i-1] + 1;
-                size_t rIdx = i == curThreadNum - 1 ? pathSequence->pathElt().size() : splitPoints[i] + 1;
-                localMaxCost = max(localMaxCost, estimateCost(path, lIdx, rIdx, csrPtr));   // Cost verified
+                size_t rIdx = i == curThreadNum - 1 ? pathElts.size() : splitPoints[i] + 1;
+                localMaxCost = max(localMaxCost, estimateCost(pathElts, lIdx, rIdx, csrPtr));   // Cost verified
             }
             if (localMaxCost < minCost) {
                 minCost = localMaxCost;
                 curSplitParts.clear();
                 for (size_t i = 0; i < curThreadNum; i++) {
                     size_t lIdx = i == 0 ? 0 : splitPoints[i-1] + 1;
-                    size_t rIdx = i == curThreadNum - 1 ? pathSequence->pathElt().size() : splitPoints[i] + 1;
+                    size_t rIdx = i == curThreadNum - 1 ? pathElts.size() : splitPoints[i] + 1;
                     string curSplitPart;
                     for (size_t j = lIdx; j < rIdx; j++) {
                         if (!curSplitPart.empty())
                             curSplitPart += "/";
-                        curSplitPart += pathSequence->pathElt()[j]->getText();
+                        curSplitPart += pathElts[j];
                     }
                     curSplitParts.emplace_back(curSplitPart);
                 }
@@ -262,7 +263,7 @@ void getBestSplit(rpqParser::PathContext *path, vector<string> &splitParts, std:
             // Get next split point sequence (verified)
             int curIdx = curThreadNum - 2;
             bool terminate = false;
-            while (splitPoints[curIdx] == pathSequence->pathElt().size() - (curThreadNum - curIdx)) {
+            while (splitPoints[curIdx] == pathElts.size() - (curThreadNum - curIdx)) {
                 curIdx--;
                 if (curIdx == -1) {
                     terminate = true;
@@ -282,30 +283,26 @@ void getBestSplit(rpqParser::PathContext *path, vector<string> &splitParts, std:
     splitParts.swap(curSplitParts);
 }
 
-string removeRedundantParen(rpqParser::PathContext *path) {
+// Groups of concatenations without modifiers are spliced into the enclosing concatenation
+string removeRedundantParen(RpqAst &ast, size_t idx) {
+    const auto &node = ast.getNodes()[idx];
+    const size_t *childIdx = ast.getChildren(idx);
+    if (node.type == 'l')
+        return ast.toString(idx);
+    if (node.type != '|' && node.type != '/') {
+        if (ast.getNodes()[childIdx[0]].type == 'l')
+            return ast.toString(idx);
+        return "(" + removeRedundantParen(ast, childIdx[0]) + ")" + node.type;
+    }
     string ret;
-    size_t pathSequenceNum = path->pathSequence().size();
-    for (size_t i = 0; i < pathSequenceNum; i++) {
+    for (size_t i = 0; i < node.numChildren; i++) {
         if (i > 0)
-            ret += "|";
-        rpqParser::PathSequenceContext *pathSequence = path->pathSequence()[i];
-        size_t pathEltNum = pathSequence->pathElt().size();
-        for (size_t j = 0; j < pathEltNum; j++) {
-            if (j > 0)
-                ret += "/";
-            rpqParser::PathEltContext *pathElt = pathSequence->pathElt()[j];
-            if (pathElt->pathPrimary()->path()) {
-                // If no pathMod and the lowest-precedence op is /, safe to remove parentheses
-                if (!pathElt->pathMod() && pathElt->pathPrimary()->path()->pathSequence().size() == 1)
-                    ret += removeRedundantParen(pathElt->pathPrimary()->path());
-                else {
-                    ret += "(" + removeRedundantParen(pathElt->pathPrimary()->path()) + ")";
-                    if (pathElt->pathMod())
-                        ret += pathElt->pathMod()->getText();
-                }
-            } else
-                ret += pathElt->getText();
-        }
+            ret += node.type;
+        // Keep the parentheses of alternations in concatenations, and those of nested alternations
+        if (ast.getNodes()[childIdx[i]].type == '|')
+            ret += "(" + removeRedundantParen(ast, childIdx[i]) + ")";
+        else
+            ret += removeRedundantParen(ast, childIdx[i]);
     }
     return ret;
 }
@@ -324,22 +321,11 @@ int main() {
         qSet.emplace(q);
 
     // Remove redundant parentheses
+    RpqAst ast;
+    vector<string> pathElts;
     for (const string &query : qSet) {
-        istringstream ifs(query);
-        RpqErrorListener lstnr;
-
-        antlr4::ANTLRInputStream input(ifs);
-        rpqLexer lexer(&input);
-        lexer.removeErrorListeners();
-        lexer.addErrorListener(&lstnr);
-
-        antlr4::CommonTokenStream tokens(&lexer);
-        rpqParser parser(&tokens);
-        parser.removeErrorListeners();
-        parser.addErrorListener(&lstnr);
-
-        rpqParser::PathContext *path = parser.path();
-        string cleanQuery = removeRedundantParen(path);
+        ast.parse(query);
+        string cleanQuery = removeRedundantParen(ast, ast.getRoot());
         qMap[cleanQuery] = vector<string>();
         // cout << query << " " << cleanQuery << endl;
     }
@@ -348,45 +334,31 @@ int main() {
     // or includes a Kleene closure that is not a single label's
     for (auto &p: qMap) {
         string query = p.first;
-        istringstream ifs(query);
-        RpqErrorListener lstnr;
-
-        antlr4::ANTLRInputStream input(ifs);
-        rpqLexer lexer(&input);
-        lexer.removeErrorListeners();
-        lexer.addErrorListener(&lstnr);
-
-        antlr4::CommonTokenStream tokens(&lexer);
-        rpqParser parser(&tokens);
-        parser.removeErrorListeners();
-        parser.addErrorListener(&lstnr);
-
-        rpqParser::PathContext *path = parser.path();
-        if (path->pathSequence().size() == 1 && path->pathSequence()[0]->pathElt().size() == 1) {
-            rpqParser::PathEltContext *pathElt = path->pathSequence()[0]->pathElt()[0];
-            if (pathElt->pathMod()) {
-                string pathModStr = pathElt->pathMod()->getText();
-                if (pathModStr == "*" || pathModStr == "+") {
-                    cout << "Cannot decompose: " << query << endl;
-                    continue;
-                }
-            }
+        ast.parse(query);
+        size_t root = ast.getRoot();
+        const auto &rootNode = ast.getNodes()[root];
+        vector<size_t> branchIdx(1, root);
+        if (rootNode.type == '|')
+            branchIdx.assign(ast.getChildren(root), ast.getChildren(root) + rootNode.numChildren);
+        if (rootNode.type == '*' || rootNode.type == '+') {
+            cout << "Cannot decompose: " << query << endl;
+            continue;
         } else {
             bool cannotDecompose = false;
-            for (const auto &pathSequence: path->pathSequence()) {
-                for (const auto &pathElt : pathSequence->pathElt()) {
-                    if (pathElt->pathPrimary()->path() && pathElt->pathMod()) {
-                        rpqParser::PathContext *innerPath = pathElt->pathPrimary()->path();
-                        if (innerPath->pathSequence().size() == 1 && innerPath->pathSequence()[0]->pathElt().size() == 1
-                            && !innerPath->pathSequence()[0]->pathElt()[0]->pathMod() && innerPath->pathSequence()[0]->pathElt()[0]->pathPrimary()->iri())
-                            continue;
-                        string pathModStr = pathElt->pathMod()->getText();
-                        if (pathModStr == "*" || pathModStr == "+") {
-                            cout << "Cannot decompose: " << query << endl;
-                            cannotDecompose = true;
-                            break;
-                        }
-                    }
+            for (size_t branch : branchIdx) {
+                vector<size_t> eltIdx(1, branch);
+                if (ast.getNodes()[branch].type == '/')
+                    eltIdx.assign(ast.getChildren(branch), ast.getChildren(branch) + ast.getNodes()[branch].numChildren);
+                for (size_t elt : eltIdx) {
+                    char type = ast.getNodes()[elt].type;
+                    if (type != '*' && type != '+')
+                        continue;
+                    // Closures of single labels can be decomposed
+                    if (ast.getNodes()[ast.getChildren(elt)[0]].type == 'l')
+                        continue;
+                    cout << "Cannot decompose: " << query << endl;
+                    cannotDecompose = true;
+                    break;
                 }
                 if (cannotDecompose)
                     break;
@@ -394,8 +366,8 @@ int main() {
             if (cannotDecompose)
                 continue;
         }
-        for (const auto &pathSequence: path->pathSequence())
-            p.second.emplace_back(pathSequence->getText());
+        for (size_t branch : branchIdx)
+            p.second.emplace_back(ast.toString(branch));
     }
 
     // Decompose workload queries
@@ -405,39 +377,29 @@ int main() {
         std::move(p.second.begin(), p.second.end(), std::back_inserter(decomposed));
         p.second.clear();
         for (size_t k = 0; k < decomposed.size(); k++) {
-            const auto &pathStr = decomposed[k];
-            istringstream ifs(pathStr);
-            RpqErrorListener lstnr;
-
-            antlr4::ANTLRInputStream input(ifs);
-            rpqLexer lexer(&input);
-            lexer.removeErrorListeners();
-            lexer.addErrorListener(&lstnr);
-
-            antlr4::CommonTokenStream tokens(&lexer);
-            rpqParser parser(&tokens);
-            parser.removeErrorListeners();
-            parser.addErrorListener(&lstnr);
-
-            rpqParser::PathContext *path = parser.path();
-            if (path->pathSequence().size() > 1) {
-                for (const auto &pathSequence: path->pathSequence())
-                    decomposed.emplace_back(pathSequence->getText());
+            const string pathStr = decomposed[k];   // Copy, as decomposed grows
+            ast.parse(pathStr);
+            size_t root = ast.getRoot();
+            if (ast.getNodes()[root].type == '|') {
+                for (size_t i = 0; i < ast.getNodes()[root].numChildren; i++)
+                    decomposed.emplace_back(ast.toString(ast.getChildren(root)[i]));
                 continue;
             }
-            const auto &pathEltVec = path->pathSequence()[0]->pathElt();
+            vector<size_t> eltIdx(1, root);
+            if (ast.getNodes()[root].type == '/')
+                eltIdx.assign(ast.getChildren(root), ast.getChildren(root) + ast.getNodes()[root].numChildren);
             bool cannotDecompose = true;
-            for (size_t i = 0; i < pathEltVec.size(); i++) {
-                rpqParser::PathContext *nextPath = pathEltVec[i]->pathPrimary()->path();
-                if (nextPath && nextPath->pathSequence().size() > 1) {
+            for (size_t i = 0; i < eltIdx.size(); i++) {
+                if (ast.getNodes()[eltIdx[i]].type == '|') {
                     // Concat the left and right parts with different clauses
                     string left, right;
                     for (size_t j = 0; j < i; j++)
-                        left += pathEltVec[j]->getText() + "/";
-                    for (size_t j = i + 1; j < pathEltVec.size(); j++)
-                        right += "/" + pathEltVec[j]->getText();
-                    for (const auto &nextPathSequence: nextPath->pathSequence())
-                        decomposed.emplace_back(left + nextPathSequence->getText() + right);
+                        left += ast.toString(eltIdx.data(), j, j) + "/";
+                    for (size_t j = i + 1; j < eltIdx.size(); j++)
+                        right += "/" + ast.toString(eltIdx.data(), j, j);
+                    const size_t *branchIdx = ast.getChildren(eltIdx[i]);
+                    for (size_t j = 0; j < ast.getNodes()[eltIdx[i]].numChildren; j++)
+                        decomposed.emplace_back(left + ast.toString(branchIdx, j, j) + right);
                     cannotDecompose = false;
                     break;
                 }
@@ -479,7 +441,6 @@ int main() {
     //  set newed as false, delete the object by calling reset(nullptr) on the shared_ptr
     //  - else, use naive method to execute
     // Collate the execution & planning+execution time separately
-    Rpq2NFAConvertor cvrt;
     std::chrono::microseconds subExeTime, planExeTime;
     std::chrono::_V2::steady_clock::time_point inner_start_time, inner_end_time;
     long long exeTime = 0;
@@ -490,27 +451,17 @@ int main() {
             exeTime = 0;
             start_time = std::chrono::steady_clock::now();
             for (const auto &subquery: p.second) {
-                istringstream ifs(subquery);
-                RpqErrorListener lstnr;
-                antlr4::ANTLRInputStream input(ifs);
-                rpqLexer lexer(&input);
-                lexer.removeErrorListeners();
-                lexer.addErrorListener(&lstnr);
-                antlr4::CommonTokenStream tokens(&lexer);
-                rpqParser parser(&tokens);
-                parser.removeErrorListeners();
-                parser.addErrorListener(&lstnr);
-                rpqParser::PathContext *path = parser.path();
-                rpqParser::PathSequenceContext *pathSequence = path->pathSequence()[0];
+                ast.parse(subquery);
+                getPathElts(ast, ast.getRoot(), pathElts);
 
-                if (pathSequence->pathElt().size() > 2) {
+                if (pathElts.size() > 2) {
                     // Planning:
                     // Single-label cost = #edges
                     // Only 3 cases: concatenation of single labels, single-label-Kleene closures, and single-label "?"
                     // Treat single-label "?" in the same way as single labels
                     // Distinguish between labels and label inverses
                     vector<string> splitParts;
-                    getBestSplit(path, splitParts, csrPtr);
+                    getBestSplit(pathElts, splitParts, csrPtr);
                     size_t numSplitParts = splitParts.size();
                     vector<shared_ptr<MappedCSR>> resPtrVec(numSplitParts, nullptr);
 
@@ -518,8 +469,9 @@ int main() {
                     // Multi-thread execution
                     #pragma omp parallel for
                     for (size_t i = 0; i < numSplitParts; i++) {
-                        shared_ptr<NFA> dfaPtr = cvrt.convert(splitParts[i])->convert2Dfa();
-                        resPtrVec[i] = dfaPtr->execute(csrPtr);
+                        // Parts may share a cached automaton, so execute with the const engine (as the naive branch does)
+                        shared_ptr<const NFA> dfaPtr = AutomatonCache::instance().get(splitParts[i], AutomatonCache::DFA);
+                        resPtrVec[i] = dfaPtr->executeBitParallel(csrPtr);
                     }
                     // Single-thread join
                     // two at a time (i and i+1), put the result into i+1 slot. Final result: resPtrVec[numSplitParts-1]
@@ -541,8 +493,8 @@ int main() {
                 } else {
                     // Naive execution
                     inner_start_time = std::chrono::steady_clock::now();
-                    shared_ptr<NFA> dfaPtr = cvrt.convert(subquery)->convert2Dfa();
-                    shared_ptr<MappedCSR> res = dfaPtr->execute(csrPtr);
+                    shared_ptr<const NFA> dfaPtr = AutomatonCache::instance().get(subquery, AutomatonCache::DFA);
+                    shared_ptr<MappedCSR> res = dfaPtr->executeBitParallel(csrPtr);
                     inner_end_time = std::chrono::steady_clock::now();
                     subExeTime = std::chrono::duration_cast<std::chrono::microseconds>(inner_end_time - inner_start_time);
                 }